@@ -0,0 +1,296 @@
+#include "ab_comparison.h"
+#include "child_process.h"
+#include "host_info.h"
+#include "observation.h"
+#include "raw_times.h"
+#include "statistics.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+const char *buildNames[] = {"baseline", "candidate"};
+
+// The times of one benchmark as written to the raw times file, per build and per round
+struct Series {
+    // See getSeriesName
+    std::string name;
+    std::string benchmarkName;
+    std::string benchmarkSubType;
+    unsigned int batchSize;
+    unsigned int numThreads;
+    ConcurrencyMode mode;
+    std::vector<std::vector<float>> roundTimes[2];
+};
+
+struct ABResults {
+    std::string sdkVersions[2];
+    std::string hostFingerprints[2];
+    // In the order the benchmarks first ran
+    std::vector<Series> series;
+    std::map<std::string, size_t> seriesIndex;
+};
+
+ConcurrencyMode parseConcurrencyMode(const std::string &mode) {
+    if (mode == "shared SDK") {
+        return ConcurrencyMode::SHARED_SDK;
+    } else if (mode == "SDK per thread") {
+        return ConcurrencyMode::SDK_PER_THREAD;
+    }
+    return ConcurrencyMode::SINGLE_THREAD;
+}
+
+// Adds the times of the raw times file of a run to the round of the build
+bool readRawTimes(const std::string &path, int build, unsigned int round, ABResults &results) {
+    RawTimesFile file;
+    if (!readRawTimesFile(path, file)) {
+        return false;
+    }
+    results.sdkVersions[build] = getMetadata(file, "SDK Version");
+    results.hostFingerprints[build] = getMetadata(file, "Host Fingerprint");
+
+    for (const auto &time : file.times) {
+        const auto name = getSeriesName(time);
+        auto it = results.seriesIndex.find(name);
+        if (it == results.seriesIndex.end()) {
+            Series series{name,
+                          time.benchmarkName,
+                          time.benchmarkSubType,
+                          time.batchSize,
+                          time.numThreads,
+                          parseConcurrencyMode(time.concurrencyMode),
+                          {}};
+            it = results.seriesIndex.emplace(name, results.series.size()).first;
+            results.series.push_back(series);
+        }
+        auto &roundTimes = results.series[it->second].roundTimes[build];
+        roundTimes.resize(std::max<size_t>(roundTimes.size(), round + 1));
+        roundTimes[round].push_back(time.time);
+    }
+    return true;
+}
+
+std::vector<float> poolRounds(const std::vector<std::vector<float>> &roundTimes) {
+    std::vector<float> times;
+    for (const auto &round : roundTimes) {
+        times.insert(times.end(), round.begin(), round.end());
+    }
+    return times;
+}
+
+// The pooled times of a build in the observation schema. The raw times are per inference in ms,
+// while observations take the time of a whole batch in ns. The raw times do not keep the
+// throughput of the concurrent runs, which is estimated from the mean latency of the threads.
+Observation makeObservation(const ABResults &results, const Series &series, int build) {
+    const auto times = poolRounds(series.roundTimes[build]);
+    auto params = Parameters{false, 0, series.batchSize, 0, series.numThreads, {}, {}, {0, true},
+                             {}, {}};
+    params.numIterations = static_cast<unsigned int>(times.size());
+    std::vector<float> batchTimes;
+    batchTimes.reserve(times.size());
+    for (auto time : times) {
+        batchTimes.push_back(time * 1e6f * series.batchSize);
+    }
+    const std::string version = results.sdkVersions[build] + " (" + buildNames[build] + ")";
+    if (series.mode == ConcurrencyMode::SINGLE_THREAD) {
+        return Observation(version, false, series.benchmarkName, series.benchmarkSubType, params,
+                           batchTimes, MemoryProfile{});
+    }
+    const float mean = std::accumulate(times.begin(), times.end(), 0.f) / times.size();
+    const ThroughputResult throughput{series.mode, series.numThreads,
+                                      mean > 0.f ? series.numThreads * 1000.f / mean : 0.f, 0.f,
+                                      {}};
+    return Observation(version, false, series.benchmarkName, series.benchmarkSubType, params,
+                       batchTimes, MemoryProfile{}, throughput);
+}
+
+// Prints the speedup of the candidate over the baseline for every benchmark. The pooled times
+// give the speedup and its significance, and the rounds in which the candidate was faster tell
+// whether the speedup held up through the drift of the machine.
+int printReport(const ABResults &results) {
+    std::cout << "==========================" << std::endl;
+    std::cout << "SDK version: " << results.sdkVersions[0] << " -> " << results.sdkVersions[1]
+              << std::endl;
+    if (results.sdkVersions[0] == results.sdkVersions[1]) {
+        std::cout << "Both builds report the same version, make sure they are different builds "
+                     "and that run_benchmarks loads libtf dynamically"
+                  << std::endl;
+    }
+    if (results.hostFingerprints[0] != results.hostFingerprints[1]) {
+        std::cout << "Warning: the host changed between the runs" << std::endl;
+    }
+    std::cout << std::endl;
+
+    std::cout << std::left << std::setw(70) << "Benchmark" << std::right << std::setw(14)
+              << "Baseline (ms)" << std::setw(15) << "Candidate (ms)" << std::setw(10)
+              << "Speedup" << std::setw(20) << "95% CI" << std::setw(10) << "p-value"
+              << std::setw(15) << "Rounds faster"
+              << "  Result" << std::endl;
+
+    const double alpha = 0.05;
+    const double minChange = 0.02;
+    int numRegressions = 0;
+    for (const auto &series : results.series) {
+        const auto &name = series.name;
+        if (series.roundTimes[0].empty() || series.roundTimes[1].empty()) {
+            std::cout << std::left << std::setw(70) << name << " only in the "
+                      << (series.roundTimes[0].empty() ? "candidate" : "baseline") << std::endl;
+            continue;
+        }
+
+        const auto baselineTimes = poolRounds(series.roundTimes[0]);
+        const auto candidateTimes = poolRounds(series.roundTimes[1]);
+        // speedup > 1 means the candidate is faster
+        const auto speedup = bootstrapMedianRatio(baselineTimes, candidateTimes, 0.95);
+        const auto test = mannWhitneyU(baselineTimes, candidateTimes);
+
+        const size_t numRounds = std::min(series.roundTimes[0].size(), series.roundTimes[1].size());
+        size_t numRoundsFaster = 0;
+        for (size_t round = 0; round < numRounds; ++round) {
+            if (series.roundTimes[0][round].empty() || series.roundTimes[1][round].empty()) {
+                continue;
+            }
+            numRoundsFaster +=
+                median(series.roundTimes[0][round]) > median(series.roundTimes[1][round]);
+        }
+
+        const bool isSignificant = test.pValue < alpha;
+        std::string result = "no change";
+        if (isSignificant && speedup.low > 1.0 && speedup.estimate - 1.0 >= minChange) {
+            result = "faster";
+        } else if (isSignificant && speedup.high < 1.0 && 1.0 - speedup.estimate >= minChange) {
+            result = "REGRESSION";
+            ++numRegressions;
+        }
+
+        std::ostringstream ci;
+        ci << std::fixed << std::setprecision(3) << "[" << speedup.low << ", " << speedup.high
+           << "]";
+        const std::string roundsFaster =
+            std::to_string(numRoundsFaster) + "/" + std::to_string(numRounds);
+
+        std::cout << std::left << std::setw(70) << name << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(14) << median(baselineTimes)
+                  << std::setw(15) << median(candidateTimes) << std::setw(9) << speedup.estimate
+                  << "x" << std::setw(20) << ci.str() << std::setw(10) << std::setprecision(4)
+                  << test.pValue << std::setw(15) << roundsFaster << "  " << result << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+
+    std::cout << std::endl << numRegressions << " regression(s)" << std::endl;
+    return numRegressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#if !defined(WIN32) && !defined(_WIN32)
+bool runChild(const std::string &program, const std::vector<std::string> &args,
+              const std::string &libraryPath, const std::string &rawTimesPath) {
+    // A directory is searched for the library, which is preloaded when found so that it wins
+    // over a libtf found elsewhere, such as in the rpath of the executable
+    struct stat fileStatus;
+    if (::stat(libraryPath.c_str(), &fileStatus) != 0) {
+        std::cout << "Error: " << libraryPath << " does not exist" << std::endl;
+        return false;
+    }
+    std::string libraryDirectory = libraryPath;
+    std::string library = libraryPath;
+    if (S_ISDIR(fileStatus.st_mode)) {
+        library = libraryPath + "/libtf.so";
+    } else {
+        const auto slash = libraryPath.find_last_of('/');
+        libraryDirectory = slash == std::string::npos ? "." : libraryPath.substr(0, slash);
+    }
+    const bool hasLibrary =
+        ::stat(library.c_str(), &fileStatus) == 0 && S_ISREG(fileStatus.st_mode);
+
+    // The directory also provides the dependencies of the build, such as ONNX Runtime
+    std::map<std::string, std::string> environment;
+    std::string libraryPaths = libraryDirectory;
+    if (const char *previous = std::getenv("LD_LIBRARY_PATH")) {
+        libraryPaths += std::string(":") + previous;
+    }
+    environment["LD_LIBRARY_PATH"] = libraryPaths;
+    if (hasLibrary) {
+        environment["LD_PRELOAD"] = library;
+    }
+
+    auto childArgs = args;
+    childArgs.push_back("--raw-times");
+    childArgs.push_back(rawTimesPath);
+    return runSelfInChild(program, childArgs, environment);
+}
+#endif
+
+} // namespace
+
+int runABComparison(const std::string &program, const std::vector<std::string> &args,
+                    const ABOptions &options) {
+#if !defined(WIN32) && !defined(_WIN32)
+    const std::string libraryPaths[] = {options.baselineLibraryPath,
+                                        options.candidateLibraryPath};
+    ABResults results;
+    for (unsigned int round = 0; round < options.numRounds; ++round) {
+        // baseline first in the even rounds and candidate first in the odd ones, so that a drift
+        // of the clock or temperature over a round weighs on both builds alike
+        for (int i = 0; i < 2; ++i) {
+            const int build = round % 2 == 0 ? i : 1 - i;
+            std::cout << "==========================" << std::endl;
+            std::cout << "Round " << round + 1 << " of " << options.numRounds << ", "
+                      << buildNames[build] << " " << libraryPaths[build] << std::endl;
+
+            const std::string rawTimesPath = std::string("ab_raw_times_") + buildNames[build] +
+                                             "_" + std::to_string(round + 1) + ".csv";
+            if (!runChild(program, args, libraryPaths[build], rawTimesPath) ||
+                !readRawTimes(rawTimesPath, build, round, results)) {
+                std::cout << "Error: the benchmarks failed with the " << buildNames[build]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (results.series.empty()) {
+        std::cout << "Error: no benchmark was run" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ObservationList observations;
+    for (const auto &series : results.series) {
+        for (int build = 0; build < 2; ++build) {
+            if (!series.roundTimes[build].empty()) {
+                observations.push_back(makeObservation(results, series, build));
+            }
+        }
+    }
+    ObservationCSVWriter csv{options.csvPath, HostInfo::detect(results.sdkVersions[0])};
+    csv.write(observations);
+
+    const int exitCode = printReport(results);
+    std::cout << "The observations of both builds were written to " << options.csvPath
+              << std::endl;
+    return exitCode;
+#else
+    (void)program;
+    (void)args;
+    (void)options;
+    std::cout << "The A/B comparison is not supported on Windows, run the benchmarks with each "
+                 "build and compare their raw times with compare_benchmarks instead"
+              << std::endl;
+    return EXIT_FAILURE;
+#endif
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
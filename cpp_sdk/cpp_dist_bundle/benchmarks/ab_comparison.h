@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+struct ABOptions {
+    // The libtf builds to compare, either the libraries or the directories holding them
+    std::string baselineLibraryPath;
+    std::string candidateLibraryPath;
+    // Runs of every build. The build which runs first alternates from one round to the next.
+    unsigned int numRounds;
+    // File the observations of both builds are appended to
+    std::string csvPath;
+};
+
+// Runs run_benchmarks again with each of the two libtf builds in turn. Every run is a new process
+// whose dynamic loader is pointed at the build, through LD_PRELOAD and LD_LIBRARY_PATH, so both
+// builds run the same benchmark plan. The children get the given arguments and write their raw
+// times, which are pooled per build to report the speedup of every benchmark along with how many
+// rounds agree on it. Returns EXIT_FAILURE if a child failed or a benchmark regressed.
+int runABComparison(const std::string &program, const std::vector<std::string> &args,
+                    const ABOptions &options);
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,24 @@
+#include "allocation_counters.h"
+
+#if defined(__GLIBC__)
+// Only resolved when the malloc hook is linked in or preloaded
+extern "C" __attribute__((weak)) void
+trueface_benchmarks_read_allocation_counters(Trueface::Benchmarks::AllocationCounters *);
+#endif
+
+namespace Trueface {
+namespace Benchmarks {
+
+bool readAllocationCounters(AllocationCounters &counters) {
+#if defined(__GLIBC__)
+    if (trueface_benchmarks_read_allocation_counters) {
+        trueface_benchmarks_read_allocation_counters(&counters);
+        return true;
+    }
+#endif
+    (void)counters;
+    return false;
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
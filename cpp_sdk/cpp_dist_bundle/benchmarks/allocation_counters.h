@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Totals of every call to the allocator made by the process since it started, counted by the
+// malloc hook in malloc_hook.cpp. Sizes are the usable sizes of the allocations.
+struct AllocationCounters {
+    uint64_t numAllocations;
+    uint64_t numFrees;
+    uint64_t bytesAllocated;
+    int64_t liveBytes;
+};
+
+// Returns false when the malloc hook is neither linked in (-DBENCHMARK_MALLOC_HOOK=ON) nor
+// preloaded (LD_PRELOAD=libmalloc_hook.so), in which case the counters are left untouched.
+bool readAllocationCounters(AllocationCounters &counters);
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -1,13 +1,25 @@
 // The following code runs speed benchmarks for the different modules
 // The first few inferences are discarded to ensure caching is hot
 
+#include "ab_comparison.h"
 #include "benchmark.h"
+#include "cpu_environment.h"
+#include "fixture.h"
+#include "host_info.h"
 #include "observation.h"
+#include "registry.h"
 #include "sdkfactory.h"
+#include "soak.h"
 #include "stopwatch.h"
+#include "thread_sweep.h"
+#include "trace.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -15,7 +27,256 @@
 
 using namespace Trueface;
 
-int main() {
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program
+              << " [--threads N] [--raw-times PATH] [--fixed-iterations] [--ci-target PERCENT]"
+                 " [--ci-statistic mean|p99] [--time-budget SECONDS] [--cold-start N]"
+                 " [--global-threadpool on|off] [--sweep-inference-threads] [--sweep-csv PATH]"
+                 " [--corpus DIR] [--open-loop constant|poisson] [--open-loop-rates R1,R2,...]"
+                 " [--open-loop-duration SECONDS] [--soak HOURS] [--soak-window SECONDS]"
+                 " [--soak-csv PATH] [--filter TEXT] [--no-sdk-cache] [--trace PATH]"
+                 " [--ab BASELINE CANDIDATE] [--ab-rounds N] [--ab-csv PATH]"
+                 " [--pin-cpus isolated|LIST]"
+              << std::endl;
+    std::cout << "  --threads N  also measure the throughput of N concurrent threads, both sharing "
+                 "one SDK instance and using one SDK instance per thread"
+              << std::endl;
+    std::cout << "  --raw-times PATH  write the time of every iteration to a csv file" << std::endl;
+    std::cout << "  --fixed-iterations  run a fixed number of warmup and timed iterations per "
+                 "benchmark instead of iterating until the results are stable"
+              << std::endl;
+    std::cout << "  --ci-target PERCENT  stop once the 95% confidence interval half width is "
+                 "within PERCENT of the statistic (default 1)"
+              << std::endl;
+    std::cout << "  --ci-statistic mean|p99  statistic the confidence interval is computed for "
+                 "(default mean)"
+              << std::endl;
+    std::cout << "  --time-budget SECONDS  maximum time spent on each benchmark (default 30)"
+              << std::endl;
+    std::cout << "  --cold-start N  instead of the steady state latency, measure the SDK "
+                 "construction, the eager model loads and the lazy first inferences N times in "
+                 "fresh processes, with a cold and a warm page cache"
+              << std::endl;
+    std::cout << "  --global-threadpool on|off  set ConfigurationOptions.useGlobalInferenceThreadpool "
+                 "(default on). The number of inference threads is set with OMP_NUM_THREADS"
+              << std::endl;
+    std::cout << "  --sweep-inference-threads  run the benchmarks for every number of inference "
+                 "threads from 1 to the number of cores, with the global threadpool on and off"
+              << std::endl;
+    std::cout << "  --sweep-csv PATH  append the latency and throughput of every benchmark to PATH "
+                 "(default thread_sweep.csv with --sweep-inference-threads)"
+              << std::endl;
+    std::cout << "  --corpus DIR  instead of the single image benchmarks, time face detection, "
+                 "alignment and recognition over every image below DIR, bucketed by resolution "
+                 "and detected face count"
+              << std::endl;
+    std::cout << "  --open-loop constant|poisson  after the closed loop latency, issue requests at "
+                 "a sweep of arrival rates with constant or Poisson interarrival times, measure "
+                 "their latency from their scheduled arrival, and find the saturation knee"
+              << std::endl;
+    std::cout << "  --open-loop-rates R1,R2,...  offered rates in requests per second (default "
+                 "25% to 110% of the closed loop capacity)"
+              << std::endl;
+    std::cout << "  --open-loop-duration SECONDS  duration of the arrivals at every rate "
+                 "(default 10)"
+              << std::endl;
+    std::cout << "  --soak HOURS  instead of the benchmarks, cycle the module mix for HOURS and fit "
+                 "trends to the memory, open files and latency percentiles of every window to "
+                 "flag leaks and drift"
+              << std::endl;
+    std::cout << "  --soak-window SECONDS  duration of the soak windows (default 300)" << std::endl;
+    std::cout << "  --soak-csv PATH  file the soak windows are written to (default soak.csv)"
+              << std::endl;
+    std::cout << "  --filter TEXT  only run the benchmarks whose name contains TEXT" << std::endl;
+    std::cout << "  --no-sdk-cache  create an SDK instance per benchmark instead of sharing one "
+                 "per configuration, so that the memory of every benchmark includes its model "
+                 "loads"
+              << std::endl;
+    std::cout << "  --trace PATH  write every warmup and timed iteration to PATH as Chrome trace "
+                 "events, to be opened in Perfetto"
+              << std::endl;
+    std::cout << "  --ab BASELINE CANDIDATE  run the benchmarks with two libtf builds, each given "
+                 "as the library or its directory, in alternating child processes and report the "
+                 "speedup of the candidate"
+              << std::endl;
+    std::cout << "  --ab-rounds N  runs of every build with --ab (default 4)" << std::endl;
+    std::cout << "  --ab-csv PATH  file the observations of both builds are appended to "
+                 "(default ab_benchmarks.csv)"
+              << std::endl;
+    std::cout << "  --pin-cpus isolated|LIST  run the benchmarks, and the threads of the SDK, only "
+                 "on the isolated CPUs of the kernel or on a CPU list such as 2-5,8"
+              << std::endl;
+}
+
+// Parses the whole of a numeric argument, false when it is not a number
+bool parseUnsigned(const char *arg, unsigned int &value) {
+    char *end = nullptr;
+    const unsigned long parsed = std::strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || std::strchr(arg, '-')) {
+        return false;
+    }
+    value = static_cast<unsigned int>(parsed);
+    return true;
+}
+
+bool parseFloat(const char *arg, float &value) {
+    char *end = nullptr;
+    const float parsed = std::strtof(arg, &end);
+    if (end == arg || *end != '\0') {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// Parses a comma separated list such as "10,20.5,40"
+bool parseFloats(const char *arg, std::vector<float> &values) {
+    std::istringstream stream{arg};
+    std::string item;
+    std::vector<float> parsed;
+    while (std::getline(stream, item, ',')) {
+        float value = 0.f;
+        if (!parseFloat(item.c_str(), value)) {
+            return false;
+        }
+        parsed.push_back(value);
+    }
+    values = parsed;
+    return !values.empty();
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int numThreads = 1;
+    std::string rawTimesPath;
+    Benchmarks::AdaptiveOptions adaptive{true, Benchmarks::StoppingStatistic::MEAN, 0.01f, 30.f,
+                                         30, 100000};
+    Benchmarks::ColdStartOptions coldStart{false, 0};
+    Benchmarks::OpenLoopOptions openLoop{false, Benchmarks::ArrivalProcess::CONSTANT, {}, 10.f};
+    Benchmarks::SoakOptions soak{false, 0.f, 300.f, "soak.csv"};
+    Benchmarks::InferenceThreading inferenceThreading{0, true};
+    auto ompNumThreads = std::getenv("OMP_NUM_THREADS");
+    if (ompNumThreads) {
+        inferenceThreading.numThreads = std::strtoul(ompNumThreads, nullptr, 10);
+    }
+    bool sweepInferenceThreads = false;
+    std::string sweepPath;
+    std::string corpusPath;
+    std::string filter;
+    bool cacheSdks = true;
+    std::string tracePath;
+    std::string pinnedCpus;
+    Benchmarks::ABOptions abOptions{"", "", 4, "ab_benchmarks.csv"};
+    std::vector<std::string> sweepArgs;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sweep-inference-threads") == 0) {
+            sweepInferenceThreads = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--sweep-csv") == 0 && i + 1 < argc) {
+            sweepPath = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--ab") == 0 && i + 2 < argc) {
+            abOptions.baselineLibraryPath = argv[++i];
+            abOptions.candidateLibraryPath = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--ab-rounds") == 0 && i + 1 < argc &&
+            parseUnsigned(argv[i + 1], abOptions.numRounds)) {
+            abOptions.numRounds = std::max(1u, abOptions.numRounds);
+            ++i;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--ab-csv") == 0 && i + 1 < argc) {
+            abOptions.csvPath = argv[++i];
+            continue;
+        }
+
+        // every other argument is passed on to the runs of the sweep or of the A/B comparison
+        const int firstArg = i;
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc &&
+            parseUnsigned(argv[i + 1], numThreads)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--raw-times") == 0 && i + 1 < argc) {
+            rawTimesPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--fixed-iterations") == 0) {
+            adaptive.enabled = false;
+        } else if (std::strcmp(argv[i], "--ci-target") == 0 && i + 1 < argc &&
+                   parseFloat(argv[i + 1], adaptive.targetRelativeError)) {
+            adaptive.targetRelativeError /= 100.f;
+            ++i;
+        } else if (std::strcmp(argv[i], "--ci-statistic") == 0 && i + 1 < argc &&
+                   (std::strcmp(argv[i + 1], "mean") == 0 ||
+                    std::strcmp(argv[i + 1], "p99") == 0)) {
+            adaptive.statistic = std::strcmp(argv[++i], "p99") == 0
+                                     ? Benchmarks::StoppingStatistic::P99
+                                     : Benchmarks::StoppingStatistic::MEAN;
+        } else if (std::strcmp(argv[i], "--time-budget") == 0 && i + 1 < argc &&
+                   parseFloat(argv[i + 1], adaptive.timeBudget)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--cold-start") == 0 && i + 1 < argc &&
+                   parseUnsigned(argv[i + 1], coldStart.numRepetitions)) {
+            coldStart.enabled = true;
+            ++i;
+        } else if (std::strcmp(argv[i], "--global-threadpool") == 0 && i + 1 < argc &&
+                   (std::strcmp(argv[i + 1], "on") == 0 ||
+                    std::strcmp(argv[i + 1], "off") == 0)) {
+            inferenceThreading.useGlobalThreadpool = std::strcmp(argv[++i], "on") == 0;
+        } else if (std::strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            corpusPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--open-loop") == 0 && i + 1 < argc &&
+                   (std::strcmp(argv[i + 1], "constant") == 0 ||
+                    std::strcmp(argv[i + 1], "poisson") == 0)) {
+            openLoop.enabled = true;
+            openLoop.arrivals = std::strcmp(argv[++i], "poisson") == 0
+                                    ? Benchmarks::ArrivalProcess::POISSON
+                                    : Benchmarks::ArrivalProcess::CONSTANT;
+        } else if (std::strcmp(argv[i], "--open-loop-rates") == 0 && i + 1 < argc &&
+                   parseFloats(argv[i + 1], openLoop.rates)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--open-loop-duration") == 0 && i + 1 < argc &&
+                   parseFloat(argv[i + 1], openLoop.duration)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--soak") == 0 && i + 1 < argc &&
+                   parseFloat(argv[i + 1], soak.duration)) {
+            soak.enabled = true;
+            ++i;
+        } else if (std::strcmp(argv[i], "--soak-window") == 0 && i + 1 < argc &&
+                   parseFloat(argv[i + 1], soak.windowDuration)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--soak-csv") == 0 && i + 1 < argc) {
+            soak.csvPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--no-sdk-cache") == 0) {
+            cacheSdks = false;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--pin-cpus") == 0 && i + 1 < argc) {
+            pinnedCpus = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        sweepArgs.insert(sweepArgs.end(), argv + firstArg, argv + i + 1);
+    }
+
+    // in a new program, so that the OpenMP runtime is loaded with the pinned CPUs. The sweep and
+    // the A/B comparison run their children on the pinned CPUs too.
+    if (!pinnedCpus.empty() && !Benchmarks::isPinnedToCpus()) {
+        Benchmarks::restartPinnedToCpus(pinnedCpus, argv);
+        return EXIT_FAILURE;
+    }
+
+    if (!abOptions.baselineLibraryPath.empty()) {
+        return Benchmarks::runABComparison(argv[0], sweepArgs, abOptions);
+    }
+
+    if (sweepInferenceThreads) {
+        return Benchmarks::runInferenceThreadSweep(
+            argv[0], sweepArgs, sweepPath.empty() ? "thread_sweep.csv" : sweepPath);
+    }
+
     uint32_t batchSize = 16;
     GPUOptions gpuOptions = Benchmarks::SDKFactory::createGPUOptions(
         false,     // enableGPU,  NOTE: set this to true to benchmark on GPU
@@ -31,6 +292,28 @@ int main() {
     } else {
         std::cout << "Using CPU for inference" << std::endl;
     }
+    std::cout << Benchmarks::describe(Benchmarks::CpuEnvironment::capture()) << std::endl;
+    if (coldStart.enabled) {
+        std::cout << "Measuring the cold start " << coldStart.numRepetitions << " times"
+                  << std::endl;
+    } else if (adaptive.enabled) {
+        std::cout << "Iterating until the 95% confidence interval of the "
+                  << (adaptive.statistic == Benchmarks::StoppingStatistic::P99 ? "p99" : "mean")
+                  << " is within " << adaptive.targetRelativeError * 100.f << "% or "
+                  << adaptive.timeBudget << " s per benchmark" << std::endl;
+    }
+    if (!corpusPath.empty()) {
+        std::cout << "Benchmarking the images in " << corpusPath << std::endl;
+    }
+    if (numThreads > 1) {
+        std::cout << "Measuring throughput with " << numThreads << " threads" << std::endl;
+    }
+    if (openLoop.enabled && !coldStart.enabled) {
+        std::cout << "Driving every benchmark open loop with "
+                  << (openLoop.arrivals == Benchmarks::ArrivalProcess::POISSON ? "Poisson"
+                                                                               : "constant")
+                  << " arrivals for " << openLoop.duration << " s per rate" << std::endl;
+    }
     std::cout << "==========================" << std::endl;
     std::cout << "==========================" << std::endl;
 
@@ -40,61 +323,68 @@ int main() {
     }
 
     bool warmup = true; // Warmup inference to ensure caching is hot
-    int numWarmup = 10;
+    int numWarmup = 10; // Minimum number of warmup iterations in adaptive mode
+    // The number of iterations is only used with --fixed-iterations
+    auto params = [&](unsigned int batchSize, unsigned int numIterations) {
+        return Benchmarks::Parameters{warmup,     numWarmup, batchSize, numIterations,
+                                      numThreads, adaptive,  coldStart, inferenceThreading,
+                                      {},         openLoop};
+    };
     Benchmarks::SDKFactory sdkFactory(gpuOptions);
     Benchmarks::ObservationList observations;
 
-    benchmarkPreprocessImage(sdkFactory, {warmup, numWarmup, 1, 200}, observations);
-
-    benchmarkFaceLandmarkDetection(sdkFactory, {warmup, numWarmup, 1, 100 * multFactor}, observations);
-
-    benchmarkHeadOrientation(sdkFactory, {warmup, numWarmup, 1, 500 * multFactor}, observations);
-
-    benchmarkGlassesDetection(sdkFactory, {warmup, numWarmup, 1, 200 * multFactor}, observations);
-
-    benchmarkSpoofDetection(sdkFactory, {warmup, numWarmup, 1, 100 * multFactor}, observations);
-
-    benchmarkObjectDetection(sdkFactory, ObjectDetectionModel::FAST, {warmup, numWarmup, 1, 100 * multFactor}, observations);
-
-    benchmarkObjectDetection(sdkFactory, ObjectDetectionModel::ACCURATE, {warmup, numWarmup, 1, 40 * multFactor}, observations);
-
-    Benchmarks::Parameters frBenchmarkParams{warmup, numWarmup, 1, 40 * multFactor};
-    std::vector<unsigned int> batchSizes;
-    if (gpuOptions.enableGPU) {
-        // Only test with batching when GPU is enabled.
-        // Batching is not supported by CPU and will not cause a speedup.
-        batchSizes = {1, batchSize};
-    } else {
-        batchSizes = {1};
+    if (soak.enabled) {
+        return Benchmarks::runSoak(sdkFactory, soak, inferenceThreading) ? EXIT_SUCCESS
+                                                                         : EXIT_FAILURE;
     }
-    // Methods which support batch inference
-    for (auto currentBatchSize : batchSizes) {
-        frBenchmarkParams.batchSize = currentBatchSize;
-        benchmarkFaceImageOrientationDetection(sdkFactory, {warmup, numWarmup, currentBatchSize, 50 * multFactor}, observations);
-
-        benchmarkDetailedLandmarkDetection(sdkFactory, {warmup, numWarmup, currentBatchSize, 100 * multFactor}, observations);
 
-        benchmarkFaceImageBlurDetection(sdkFactory, {warmup, numWarmup, currentBatchSize, 200 * multFactor}, observations);
-
-        benchmarkBlinkDetection(sdkFactory, {warmup, numWarmup, currentBatchSize, 100 * multFactor}, observations);
-
-        benchmarkMaskDetection(sdkFactory, {warmup, numWarmup, currentBatchSize, 200 * multFactor}, observations);
+    if (!tracePath.empty()) {
+        Benchmarks::enableTrace();
+    }
 
-        benchmarkFaceTemplateQualityEstimation(sdkFactory,  {warmup, numWarmup, currentBatchSize, 200 * multFactor}, observations);
+    if (!corpusPath.empty()) {
+        benchmarkCorpus(sdkFactory, corpusPath, params(1, 100 * multFactor), observations);
+    } else {
+        Benchmarks::SuiteContext suite{params, multFactor, {1}};
+        if (gpuOptions.enableGPU) {
+            // Only test with batching when GPU is enabled.
+            // Batching is not supported by CPU and will not cause a speedup.
+            suite.batchSizes = {1, batchSize};
+        }
 
-        benchmarkFaceRecognition(sdkFactory, FacialRecognitionModel::LITE_V2, frBenchmarkParams, observations);
+        Benchmarks::Fixture fixture(sdkFactory, cacheSdks);
+        for (const auto &benchmark : Benchmarks::getRegisteredBenchmarks()) {
+            if (benchmark.name.find(filter) != std::string::npos) {
+                benchmark.run(fixture, suite, observations);
+            }
+        }
+        if (cacheSdks && !coldStart.enabled) {
+            std::cout << "Created " << fixture.getNumSdksCreated() << " SDK instances, reused "
+                      << fixture.getNumSdksReused() << " times" << std::endl;
+        }
+    }
 
-        benchmarkFaceRecognition(sdkFactory, FacialRecognitionModel::LITE_V3, frBenchmarkParams, observations);
+    if (!tracePath.empty()) {
+        Benchmarks::writeTrace(tracePath);
+    }
 
-        benchmarkFaceRecognition(sdkFactory, FacialRecognitionModel::TFV5_2, frBenchmarkParams, observations);
+    if (observations.empty()) {
+        return EXIT_FAILURE;
+    }
 
-        benchmarkFaceRecognition(sdkFactory, FacialRecognitionModel::TFV6, frBenchmarkParams, observations);
+    const auto host = Benchmarks::HostInfo::detect(observations.front().getVersion());
+    Benchmarks::ObservationCSVWriter csv{"benchmarks.csv", host};
+    csv.write(observations);
 
-        benchmarkFaceRecognition(sdkFactory, FacialRecognitionModel::TFV7, frBenchmarkParams, observations);
+    if (!rawTimesPath.empty()) {
+        Benchmarks::RawTimesCSVWriter rawTimesCsv{rawTimesPath, host};
+        rawTimesCsv.write(observations);
     }
 
-    Benchmarks::ObservationCSVWriter csv{"benchmarks.csv"};
-    csv.write(observations);
+    if (!sweepPath.empty()) {
+        Benchmarks::SweepCSVWriter sweepCsv{sweepPath};
+        sweepCsv.write(observations);
+    }
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
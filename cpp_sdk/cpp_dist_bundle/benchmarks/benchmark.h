@@ -3,50 +3,18 @@
 #include "observation.h"
 #include "sdkfactory.h"
 
+#include <string>
+
 // fwd declarations
 namespace Trueface {
 enum class FacialRecognitionModel;
-enum class ObjectDetectionModel;
 } // namespace Trueface
 
-void benchmarkFaceRecognition(const Trueface::Benchmarks::SDKFactory &,
-                              Trueface::FacialRecognitionModel, Trueface::Benchmarks::Parameters,
-                              Trueface::Benchmarks::ObservationList &);
-void benchmarkObjectDetection(const Trueface::Benchmarks::SDKFactory &,
-                              Trueface::ObjectDetectionModel objModel,
-                              Trueface::Benchmarks::Parameters,
-                              Trueface::Benchmarks::ObservationList &);
-void benchmarkFaceLandmarkDetection(const Trueface::Benchmarks::SDKFactory &,
-                                    Trueface::Benchmarks::Parameters,
-                                    Trueface::Benchmarks::ObservationList &);
-void benchmarkDetailedLandmarkDetection(const Trueface::Benchmarks::SDKFactory &,
-                                        Trueface::Benchmarks::Parameters,
-                                        Trueface::Benchmarks::ObservationList &);
-void benchmarkPreprocessImage(const Trueface::Benchmarks::SDKFactory &,
-                              Trueface::Benchmarks::Parameters,
-                              Trueface::Benchmarks::ObservationList &);
-void benchmarkMaskDetection(const Trueface::Benchmarks::SDKFactory &,
-                            Trueface::Benchmarks::Parameters,
-                            Trueface::Benchmarks::ObservationList &);
-void benchmarkBlinkDetection(const Trueface::Benchmarks::SDKFactory &,
-                             Trueface::Benchmarks::Parameters,
-                             Trueface::Benchmarks::ObservationList &);
-void benchmarkSpoofDetection(const Trueface::Benchmarks::SDKFactory &,
-                             Trueface::Benchmarks::Parameters,
-                             Trueface::Benchmarks::ObservationList &);
-void benchmarkHeadOrientation(const Trueface::Benchmarks::SDKFactory &,
-                              Trueface::Benchmarks::Parameters,
-                              Trueface::Benchmarks::ObservationList &);
-void benchmarkFaceImageBlurDetection(const Trueface::Benchmarks::SDKFactory &,
-                                     Trueface::Benchmarks::Parameters,
-                                     Trueface::Benchmarks::ObservationList &);
-void benchmarkFaceImageOrientationDetection(const Trueface::Benchmarks::SDKFactory &,
-                                            Trueface::Benchmarks::Parameters,
-                                            Trueface::Benchmarks::ObservationList &);
-void benchmarkGlassesDetection(const Trueface::Benchmarks::SDKFactory &,
-                               Trueface::Benchmarks::Parameters,
-                               Trueface::Benchmarks::ObservationList &);
+// The benchmarks of the suite register themselves, see registry.h
+
+std::string getModelName(Trueface::FacialRecognitionModel);
 
-void benchmarkFaceTemplateQualityEstimation(const Trueface::Benchmarks::SDKFactory &,
-                                            Trueface::Benchmarks::Parameters,
-                                            Trueface::Benchmarks::ObservationList &);
\ No newline at end of file
+// Times detectFaces, extractAlignedFace and getFaceFeatureVectors over the images found below
+// corpusPath, bucketed by resolution and detected face count
+void benchmarkCorpus(const Trueface::Benchmarks::SDKFactory &, const std::string &corpusPath,
+                     Trueface::Benchmarks::Parameters, Trueface::Benchmarks::ObservationList &);
@@ -1,34 +1,272 @@
 // The following code runs speed benchmarks for the 1:N identification module
+#include "allocation_counters.h"
+#include "child_process.h"
+#include "collection_load.h"
+#include "host_info.h"
+#include "memory_high_water_mark.h"
+#include "mixed_workload.h"
 #include "observation.h"
 #include "sdkfactory.h"
 #include "stopwatch.h"
+#include "template_generator.h"
 
 #include "tf_sdk.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <numeric>
+#include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace Trueface;
 
-int main() {
-    auto gpuOptions = GPUOptions(false);
-    auto sdkFactory = Benchmarks::SDKFactory(gpuOptions);
+namespace {
 
-    auto options = sdkFactory.createBasicConfiguration();
-    options.frModel = FacialRecognitionModel::TFV7;
-    options.dbms = DatabaseManagementSystem::NONE;
+// Enrolls collectionSize templates one after the other, timing every call
+bool enrollSerially(SDK &sdk, const std::vector<std::pair<std::string, Faceprint>> &dataVec,
+                    size_t collectionSize, std::vector<float> &times) {
+    for (size_t i = 0; i < collectionSize; ++i) {
+        const auto &data = dataVec[i % dataVec.size()];
+        std::string UUID;
 
-    // TODO modify the following option to test with / without vector compression
-    options.frVectorCompression = true;
+        // Enroll the template and the identity
+        auto stopwatch = preciseStopwatch();
+        auto ret = sdk.enrollFaceprint(data.second, data.first, UUID);
+        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+        if (ret != ErrorCode::NO_ERROR) {
+            std::cout << "Unable to enroll template" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
-    if (options.frVectorCompression) {
-        std::cout << "~~~~~~~~~~~~~~~ Vector compression enabled ~~~~~~~~~~~~~~~~" << std::endl;
+// The SDK has no batch enrollment, so the parallel path enrolls from numThreads threads sharing
+// the SDK. Every thread enrolls an equal share of the templates, timing every call.
+bool enrollInParallel(SDK &sdk, const std::vector<std::pair<std::string, Faceprint>> &dataVec,
+                      size_t collectionSize, unsigned int numThreads, std::vector<float> &times,
+                      std::vector<float> &perThreadMean) {
+    std::vector<std::vector<float>> threadTimes(numThreads);
+    std::atomic<bool> isFailed{false};
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numThreads; ++t) {
+        threadTimes[t].reserve(collectionSize / numThreads + 1);
+        threads.emplace_back([&, t]() {
+            for (size_t i = t; i < collectionSize && !isFailed; i += numThreads) {
+                const auto &data = dataVec[i % dataVec.size()];
+                std::string UUID;
+                auto stopwatch = preciseStopwatch();
+                auto ret = sdk.enrollFaceprint(data.second, data.first, UUID);
+                threadTimes[t].emplace_back(
+                    stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+                if (ret != ErrorCode::NO_ERROR) {
+                    isFailed = true;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (isFailed) {
+        std::cout << "Unable to enroll template" << std::endl;
+        return false;
     }
 
-    auto sdk = sdkFactory.createSDK(options);
+    constexpr float nsPerMs{1000.f * 1000.f};
+    for (const auto &thread : threadTimes) {
+        times.insert(times.end(), thread.begin(), thread.end());
+        const double total = std::accumulate(thread.begin(), thread.end(), 0.0);
+        perThreadMean.push_back(
+            thread.empty() ? 0.f : static_cast<float>(total / thread.size() / nsPerMs));
+    }
+    return true;
+}
+
+// Largest batch of the batch size sweep
+constexpr size_t maxBatchSize{4096};
+
+// Distinct probes for the batch and concurrency sweeps. The synthetic templates can only stand in
+// for uncompressed ones, so the compressed sweeps cycle through the real templates instead.
+std::vector<Faceprint> createProbes(const Faceprint &probe, const Faceprint &matchTemplate,
+                                    const std::vector<std::pair<std::string, Faceprint>> &dataVec) {
+    std::vector<Faceprint> probes;
+    probes.reserve(maxBatchSize);
+    if (probe.isCompressed) {
+        std::vector<Faceprint> templates{probe, matchTemplate};
+        for (const auto &data : dataVec) {
+            templates.push_back(data.second);
+        }
+        for (size_t i = 0; i < maxBatchSize; ++i) {
+            probes.push_back(templates[i % templates.size()]);
+        }
+        return probes;
+    }
+
+    Benchmarks::TemplateGenerator generator{probe, {100, 2.f, 0.6f, 1}};
+    std::vector<float> center;
+    Faceprint faceprint;
+    for (size_t i = 0; i < maxBatchSize; ++i) {
+        generator.generateIdentity(i, center);
+        generator.generateTemplate(center, i, 0, faceprint);
+        probes.push_back(faceprint);
+    }
+    return probes;
+}
+
+// Searches batches of 1 to maxBatchSize distinct probes, and prints the smallest batch size from
+// which a batched search costs less per probe than singleMean, the mean of one search in ms
+void sweepBatchSizes(SDK &sdk, const Benchmarks::SDKFactory &sdkFactory,
+                     const std::vector<Faceprint> &probes, size_t collectionSize, float singleMean,
+                     const std::string &benchmarkSubType,
+                     const Benchmarks::MemoryProfile &collectionMemory,
+                     Benchmarks::ObservationList &observations) {
+    // Search about the same number of probes at every batch size
+    const size_t numProbes = collectionSize >= 100000 ? 256 : 2048;
+    size_t crossover = 0;
+    std::vector<Candidate> candidates;
+    std::vector<bool> foundCandidates;
+
+    for (size_t batchSize = 1; batchSize <= maxBatchSize; batchSize *= 2) {
+        const std::vector<Faceprint> batch(probes.begin(), probes.begin() + batchSize);
+        auto parameters = Benchmarks::Parameters{
+            false, 0, static_cast<unsigned int>(batchSize),
+            static_cast<unsigned int>(std::max<size_t>(3, numProbes / batchSize)),
+            1, {}, {}, {0, true}, {}, {}};
+
+        // one untimed search to allocate the results
+        sdk.batchIdentifyTopCandidate(batch, candidates, foundCandidates);
+
+        std::vector<float> times;
+        for (size_t i = 0; i < parameters.numIterations; ++i) {
+            auto stopwatch = preciseStopwatch();
+            sdk.batchIdentifyTopCandidate(batch, candidates, foundCandidates);
+            times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+        }
+
+        observations.emplace_back(sdk.getVersion(), sdkFactory.isGpuEnabled(),
+                                  "1 to N batch identification search",
+                                  benchmarkSubType + ", batch of " + std::to_string(batchSize),
+                                  parameters, times, collectionMemory);
+        if (crossover == 0 && observations.back().getTimeResult().mean < singleMean) {
+            crossover = batchSize;
+        }
+    }
+
+    if (crossover != 0) {
+        std::cout << "Batching pays off from a batch size of " << crossover
+                  << ", which costs less per probe than one search at a time" << std::endl;
+    } else {
+        std::cout << "Batching never pays off, up to a batch size of " << maxBatchSize
+                  << " one search at a time is faster" << std::endl;
+    }
+}
 
+// Searches from 1 to twice as many threads as there are cores sharing the SDK, and prints whether
+// the concurrent searches scale or serialize. Returns false on error.
+bool sweepConcurrentSearches(SDK &sdk, const Benchmarks::SDKFactory &sdkFactory,
+                             const std::vector<Faceprint> &probes, size_t collectionSize,
+                             const std::string &benchmarkSubType,
+                             Benchmarks::ObservationList &observations) {
+    const unsigned int numCores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t numSearches = collectionSize >= 100000 ? 100 : 1000;
+    constexpr float nsPerMs{1000.f * 1000.f};
+    float singleThroughput = 0.f;
+    // speedup at the largest thread count which does not oversubscribe the cores
+    unsigned int coresThreads = 1;
+    float coresSpeedup = 1.f;
+
+    for (unsigned int numThreads = 1; numThreads <= 2 * numCores; numThreads *= 2) {
+        std::vector<std::vector<float>> threadTimes(numThreads);
+        std::atomic<bool> isFailed{false};
+        std::vector<std::thread> threads;
+        auto stopwatch = preciseStopwatch();
+        for (unsigned int t = 0; t < numThreads; ++t) {
+            threadTimes[t].reserve(numSearches);
+            threads.emplace_back([&, t]() {
+                Candidate candidate;
+                bool found;
+                for (size_t i = 0; i < numSearches && !isFailed; ++i) {
+                    const auto &probe = probes[(i * numThreads + t) % probes.size()];
+                    auto searchStopwatch = preciseStopwatch();
+                    auto ret = sdk.identifyTopCandidate(probe, candidate, found);
+                    threadTimes[t].emplace_back(
+                        searchStopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+                    if (ret != ErrorCode::NO_ERROR) {
+                        isFailed = true;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        if (isFailed) {
+            std::cout << "Unable to search the collection" << std::endl;
+            return false;
+        }
+        const float throughput = numThreads * numSearches /
+                                 (stopwatch.elapsedTime<float, std::chrono::microseconds>() / 1e6f);
+
+        std::vector<float> times;
+        std::vector<float> perThreadMean;
+        for (const auto &thread : threadTimes) {
+            times.insert(times.end(), thread.begin(), thread.end());
+            const double total = std::accumulate(thread.begin(), thread.end(), 0.0);
+            perThreadMean.push_back(static_cast<float>(total / thread.size() / nsPerMs));
+        }
+        if (numThreads == 1) {
+            singleThroughput = throughput;
+        }
+        if (numThreads <= numCores) {
+            coresThreads = numThreads;
+            coresSpeedup = throughput / singleThroughput;
+        }
+
+        auto parameters = Benchmarks::Parameters{
+            false, 0, 1, static_cast<unsigned int>(numSearches), numThreads, {}, {}, {0, true},
+            {}, {}};
+        observations.emplace_back(
+            sdk.getVersion(), sdkFactory.isGpuEnabled(), "1 to N concurrent identification search",
+            benchmarkSubType, parameters, times, Benchmarks::MemoryProfile{},
+            Benchmarks::ThroughputResult{Benchmarks::ConcurrencyMode::SHARED_SDK, numThreads,
+                                         throughput, throughput / (numThreads * singleThroughput),
+                                         perThreadMean});
+    }
+
+    if (coresThreads == 1) {
+        std::cout << "Only one core, unable to tell whether concurrent searches scale" << std::endl;
+    } else if (coresSpeedup < 1.25f) {
+        std::cout << "Concurrent searches serialize: " << coresThreads << " threads search "
+                  << coresSpeedup << " times as fast as one, the collection is likely locked "
+                  << "for every search" << std::endl;
+    } else {
+        std::cout << "Concurrent searches scale: " << coresThreads << " threads search "
+                  << coresSpeedup << " times as fast as one" << std::endl;
+    }
+    return true;
+}
+
+// Collection sizes of the enrollment and search benchmarks
+const std::vector<size_t> collectionSizes{1000, 10000, 100000, 1000000};
+
+ConfigurationOptions createIdentificationOptions(const Benchmarks::SDKFactory &sdkFactory,
+                                                 bool frVectorCompression) {
+    auto options = sdkFactory.createBasicConfiguration();
+    options.frModel = FacialRecognitionModel::TFV7;
+    options.dbms = DatabaseManagementSystem::NONE;
+    options.frVectorCompression = frVectorCompression;
+    return options;
+}
+
+// Extracts the distractor templates the collections are populated with. Returns false on error.
+bool createDistractors(SDK &sdk, std::vector<std::pair<std::string, Faceprint>> &dataVec) {
     // Populate our collection with the following distractor templates
     std::vector<std::pair<std::string, std::string>> imagePairList = {
         {"../../images/tom_cruise_1.jpg", "tom cruise"},
@@ -36,16 +274,13 @@ int main() {
         {"../../images/tom_cruise_3.jpg", "tom cruise"},
         {"../images/headshot.jpg", "anon"}};
 
-    std::vector<std::pair<std::string, Faceprint>> dataVec;
-
     // Generate a template for each of the images
-    std::cout << "\nGenerating templates" << std::endl;
     for (const auto &imagePair : imagePairList) {
         TFImage img;
         auto ret = sdk.preprocessImage(imagePair.first, img);
         if (ret != ErrorCode::NO_ERROR) {
             std::cout << "Unable to set image: " << imagePair.first << std::endl;
-            return -1;
+            return false;
         }
 
         Faceprint faceprint;
@@ -54,18 +289,106 @@ int main() {
 
         if (ret != ErrorCode::NO_ERROR || !foundFace) {
             std::cout << "Unable to detect face and extract features" << std::endl;
-            return -1;
+            return false;
         }
 
         dataVec.emplace_back(imagePair.second, std::move(faceprint));
     }
+    return true;
+}
+
+// Memory taken by the templates of a collection
+struct TemplateMemory {
+    // Growth of the resident memory in MB
+    float memoryUsage;
+    bool hasAllocationCounts;
+    // Growth of the live heap in MB, with the malloc hook
+    float liveHeapGrowth;
+};
+
+// Measures the memory of the templates of every collection size, each in a child process which
+// creates its own SDK and enrolls them into an empty collection. Measured in the benchmark
+// process, the pages freed with the previous collections would be reused and hide the growth.
+// The children must be forked before this process loads the SDK. Returns false when the memory
+// cannot be measured in children, which is always the case on Windows.
+bool measureTemplateMemory(const Benchmarks::SDKFactory &sdkFactory, bool frVectorCompression,
+                           std::vector<TemplateMemory> &templateMemory) {
+#if !defined(WIN32) && !defined(_WIN32)
+    const auto options = createIdentificationOptions(sdkFactory, frVectorCompression);
+    for (auto collectionSize : collectionSizes) {
+        std::cout << "Measuring the memory of " << collectionSize << " templates" << std::endl;
+        TemplateMemory sample{};
+        const bool isMeasured = Benchmarks::measureInChild<TemplateMemory>(
+            [&](TemplateMemory &childSample) {
+                auto sdk = sdkFactory.createSDK(options);
+                std::vector<std::pair<std::string, Faceprint>> dataVec;
+                if (!createDistractors(sdk, dataVec) ||
+                    sdk.createLoadCollection("temp_collection") != ErrorCode::NO_ERROR) {
+                    return false;
+                }
+
+                // reserved before the baseline, the times are not part of the collection
+                std::vector<float> times;
+                times.reserve(collectionSize);
+                Benchmarks::AllocationCounters before{};
+                const bool hasAllocationCounts = Benchmarks::readAllocationCounters(before);
+                const float rssBefore = Benchmarks::getResidentSetSize();
+                if (!enrollSerially(sdk, dataVec, collectionSize, times)) {
+                    return false;
+                }
+                childSample.memoryUsage = Benchmarks::getResidentSetSize() - rssBefore;
+
+                Benchmarks::AllocationCounters after{};
+                if (hasAllocationCounts && Benchmarks::readAllocationCounters(after)) {
+                    childSample.hasAllocationCounts = true;
+                    childSample.liveHeapGrowth = (after.liveBytes - before.liveBytes) / 1e6f;
+                }
+                return true;
+            },
+            sample);
+        if (!isMeasured) {
+            std::cout << "Error: unable to measure the memory of the templates" << std::endl;
+            return false;
+        }
+        templateMemory.push_back(sample);
+    }
+    return true;
+#else
+    (void)sdkFactory;
+    (void)frVectorCompression;
+    (void)templateMemory;
+    return false;
+#endif
+}
+
+// Runs the enrollment and search benchmarks for every collection size with one SDK instance.
+// templateMemory holds the memory of the templates of every collection size, measured in
+// children, or is empty to measure it in this process. Returns false on error.
+bool benchmarkIdentification(const Benchmarks::SDKFactory &sdkFactory, bool frVectorCompression,
+                             const std::vector<TemplateMemory> &templateMemory,
+                             Benchmarks::ObservationList &observations) {
+    const auto options = createIdentificationOptions(sdkFactory, frVectorCompression);
+
+    if (options.frVectorCompression) {
+        std::cout << "~~~~~~~~~~~~~~~ Vector compression enabled ~~~~~~~~~~~~~~~~" << std::endl;
+    } else {
+        std::cout << "~~~~~~~~~~~~~~~ Vector compression disabled ~~~~~~~~~~~~~~~" << std::endl;
+    }
+
+    auto sdk = sdkFactory.createSDK(options);
+
+    std::vector<std::pair<std::string, Faceprint>> dataVec;
+    std::cout << "\nGenerating templates" << std::endl;
+    if (!createDistractors(sdk, dataVec)) {
+        return false;
+    }
 
     // Prepare the probe vector and the match vector
     TFImage img;
     auto ret = sdk.preprocessImage("../../images/brad_pitt_1.jpg", img);
     if (ret != ErrorCode::NO_ERROR) {
         std::cout << "Unable to set image" << std::endl;
-        return -1;
+        return false;
     }
 
     bool foundFace;
@@ -73,63 +396,139 @@ int main() {
     ret = sdk.getLargestFaceFeatureVector(img, probe, foundFace);
     if (ret != ErrorCode::NO_ERROR || !foundFace) {
         std::cout << "Unable to detect face and extract features" << std::endl;
-        return -1;
+        return false;
     }
 
     ret = sdk.preprocessImage("../../images/brad_pitt_2.jpg", img);
     if (ret != ErrorCode::NO_ERROR) {
         std::cout << "Unable to set image" << std::endl;
-        return -1;
+        return false;
     }
 
     Faceprint matchTemplate;
     ret = sdk.getLargestFaceFeatureVector(img, matchTemplate, foundFace);
     if (ret != ErrorCode::NO_ERROR || !foundFace) {
         std::cout << "Unable to detect face and extract features" << std::endl;
-        return -1;
+        return false;
     }
 
-    // Collection sizes to test
-    std::vector<size_t> collectionSizes{1000, 10000, 100000, 1000000};
+    const auto probes = createProbes(probe, matchTemplate, dataVec);
+
+    const unsigned int numEnrollmentThreads = std::max(2u, std::thread::hardware_concurrency());
+    const std::string modelName = options.frVectorCompression ? "TFV7 compressed" : "TFV7";
 
-    auto observations = Benchmarks::ObservationList();
     // Populate the collections
-    for (const auto &collectionSize : collectionSizes) {
+    for (size_t sizeIndex = 0; sizeIndex < collectionSizes.size(); ++sizeIndex) {
+        const size_t collectionSize = collectionSizes[sizeIndex];
         std::cout << "Populating collection with " << collectionSize << " templates" << std::endl;
+        const std::string benchmarkSubType =
+            "(" + std::to_string(collectionSize) + ") " + modelName;
 
         // We are using the DatabaseManagementSystem::NONE so the collection will not persist
         ret = sdk.createLoadCollection("temp_collection");
         if (ret != ErrorCode::NO_ERROR) {
             std::cout << "Error creating collection" << std::endl;
-            return -1;
+            return false;
         }
 
-        // Enroll the templates
-        // Note: we are enrolling collectionSize - 1 because we will add the matchTemplate at the
-        // end.
-        for (size_t i = 0; i < collectionSize; ++i) {
+        // Time the enrollment, and measure the memory the templates take. The resident memory
+        // freed with the previous collection may be reused, so the memory measured in a child
+        // replaces it when there is one.
+        auto parameters = Benchmarks::Parameters{false, 0, 1, 1000, 1, {}, {}, {0, true}, {}, {}};
+        parameters.numIterations = collectionSize;
+        std::vector<float> times;
+        times.reserve(collectionSize);
+
+        Benchmarks::AllocationCounters countersBefore{};
+        const bool hasAllocationCounts = Benchmarks::readAllocationCounters(countersBefore);
+        const float rssBefore = Benchmarks::getResidentSetSize();
+        auto enrollmentStopwatch = preciseStopwatch();
+        if (!enrollSerially(sdk, dataVec, collectionSize, times)) {
+            return false;
+        }
+        const float enrollmentTime =
+            enrollmentStopwatch.elapsedTime<float, std::chrono::microseconds>() / 1e6f;
+
+        Benchmarks::MemoryProfile memory{};
+        memory.memoryUsage = Benchmarks::getResidentSetSize() - rssBefore;
+        Benchmarks::AllocationCounters countersAfter{};
+        if (hasAllocationCounts && Benchmarks::readAllocationCounters(countersAfter)) {
+            memory.hasAllocationCounts = true;
+            memory.allocationsPerInference =
+                static_cast<float>(countersAfter.numAllocations - countersBefore.numAllocations) /
+                collectionSize;
+            memory.bytesPerInference =
+                static_cast<float>(countersAfter.bytesAllocated - countersBefore.bytesAllocated) /
+                collectionSize;
+            memory.liveHeapGrowth = (countersAfter.liveBytes - countersBefore.liveBytes) / 1e6f;
+        }
+        if (sizeIndex < templateMemory.size()) {
+            const auto &childMemory = templateMemory[sizeIndex];
+            memory.memoryUsage = childMemory.memoryUsage;
+            if (childMemory.hasAllocationCounts) {
+                memory.hasAllocationCounts = true;
+                memory.liveHeapGrowth = childMemory.liveHeapGrowth;
+            }
+        }
 
-            const auto &data = dataVec[i % dataVec.size()];
-            std::string UUID;
+        std::cout << "Memory per template: " << memory.memoryUsage * 1e6f / collectionSize
+                  << " bytes resident";
+        if (memory.hasAllocationCounts) {
+            std::cout << ", " << memory.liveHeapGrowth * 1e6f / collectionSize
+                      << " bytes of live heap";
+        }
+        std::cout << std::endl;
+
+        const float serialThroughput = collectionSize / enrollmentTime;
+        const float serialMean =
+            std::accumulate(times.begin(), times.end(), 0.0) / times.size() / 1e6;
+        std::string benchmarkName = "1 to N enrollment";
+        observations.emplace_back(
+            sdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, benchmarkSubType,
+            parameters, times, memory,
+            Benchmarks::ThroughputResult{Benchmarks::ConcurrencyMode::SINGLE_THREAD, 1,
+                                         serialThroughput, 1.f, {serialMean}});
+
+        // The search observations report the memory of the collection they search
+        Benchmarks::MemoryProfile collectionMemory{};
+        collectionMemory.memoryUsage = memory.memoryUsage;
+
+        // Enroll the same templates again from several threads into a new collection
+        ret = sdk.createLoadCollection("temp_collection");
+        if (ret != ErrorCode::NO_ERROR) {
+            std::cout << "Error creating collection" << std::endl;
+            return false;
+        }
 
-            // Enroll the template and the identity
-            ret = sdk.enrollFaceprint(data.second, data.first, UUID);
-            if (ret != ErrorCode::NO_ERROR) {
-                std::cout << "Unable to enroll template" << std::endl;
-                return -1;
-            }
+        times.clear();
+        std::vector<float> perThreadMean;
+        enrollmentStopwatch = preciseStopwatch();
+        if (!enrollInParallel(sdk, dataVec, collectionSize, numEnrollmentThreads, times,
+                              perThreadMean)) {
+            return false;
         }
+        const float parallelThroughput =
+            collectionSize /
+            (enrollmentStopwatch.elapsedTime<float, std::chrono::microseconds>() / 1e6f);
+
+        parameters.numThreads = numEnrollmentThreads;
+        observations.emplace_back(
+            sdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, benchmarkSubType,
+            parameters, times, Benchmarks::MemoryProfile{},
+            Benchmarks::ThroughputResult{
+                Benchmarks::ConcurrencyMode::SHARED_SDK, numEnrollmentThreads, parallelThroughput,
+                parallelThroughput / (numEnrollmentThreads * serialThroughput), perThreadMean});
 
         // Finally enroll the match template
         std::string UUID;
         ret = sdk.enrollFaceprint(matchTemplate, "Brad Pitt", UUID);
         if (ret != ErrorCode::NO_ERROR) {
             std::cout << "Unable to enroll template" << std::endl;
-            return -1;
+            return false;
         }
 
         // Run the timing tests
-        auto parameters = Benchmarks::Parameters{false, 0, 1, 1000};
+        parameters = Benchmarks::Parameters{false, 0, 1, 1000, 1, {}, {}, {0, true}, {}, {}};
         if (collectionSize >= 100000) {
             parameters.numIterations = 100;
         }
@@ -137,8 +536,7 @@ int main() {
         Candidate candidate;
         bool found;
 
-        auto times = std::vector<float>();
-        times.reserve(parameters.numIterations);
+        times.clear();
         for (size_t i = 0; i < parameters.numIterations; ++i) {
             auto stopwatch = preciseStopwatch();
             sdk.identifyTopCandidate(probe, candidate, found);
@@ -149,36 +547,322 @@ int main() {
             std::cout << "Found match: " << candidate.identity << std::endl;
         }
 
-        std::string benchmarkName = "1 to N identification search";
-        std::string benchmarkSubType = "(" + std::to_string(collectionSize) + ") TFV7";
+        benchmarkName = "1 to N identification search";
         observations.emplace_back(sdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
-                                  benchmarkSubType, parameters, times, 0.0f);
-
-        // Now run batch identification
-        std::vector<Faceprint> probeFaceprints;
-        for (size_t i = 0; i < 100; ++i) {
-            probeFaceprints.push_back(probe);
+                                  benchmarkSubType, parameters, times, collectionMemory);
+
+        // Batched and concurrent searches of distinct probes, compared to one search at a time
+        const float singleMean = observations.back().getTimeResult().mean;
+        sweepBatchSizes(sdk, sdkFactory, probes, collectionSize, singleMean, benchmarkSubType,
+                        collectionMemory, observations);
+        if (!sweepConcurrentSearches(sdk, sdkFactory, probes, collectionSize, benchmarkSubType,
+                                     observations)) {
+            return false;
         }
+    }
+
+    return true;
+}
 
-        std::vector<Candidate> candidates;
-        std::vector<bool> foundCandidates;
+struct SyntheticOptions {
+    bool enabled;
+    // The collection grows by factors of 10 from 1000 templates up to this size
+    size_t maxCollectionSize;
+    unsigned int templatesPerIdentity;
+    Benchmarks::TemplateGeneratorOptions generator;
+    // Every enrolled template is written to this file with its identity
+    std::string groundTruthPath;
+};
+
+// Grows one collection of distinct synthetic templates, and at every size measures the search
+// latency and accuracy with probes that were never enrolled: mated probes of enrolled identities,
+// and non-mated probes of identities which are never enrolled. Returns false on error.
+bool benchmarkSyntheticIdentification(const Benchmarks::SDKFactory &sdkFactory,
+                                      const SyntheticOptions &synthetic,
+                                      Benchmarks::ObservationList &observations) {
+    // The generated feature vectors are not compressed
+    auto options = sdkFactory.createBasicConfiguration();
+    options.frModel = FacialRecognitionModel::TFV7;
+    options.dbms = DatabaseManagementSystem::NONE;
+    options.frVectorCompression = false;
 
-        parameters.numWarmup /= 10;
-        parameters.batchSize = probeFaceprints.size();
+    auto sdk = sdkFactory.createSDK(options);
 
-        times.clear();
-        for (size_t i = 0; i < parameters.numIterations; ++i) {
+    // A real template gives the size and the metadata of the generated ones
+    TFImage img;
+    Faceprint prototype;
+    bool foundFace = false;
+    if (sdk.preprocessImage("../images/headshot.jpg", img) != ErrorCode::NO_ERROR ||
+        sdk.getLargestFaceFeatureVector(img, prototype, foundFace) != ErrorCode::NO_ERROR ||
+        !foundFace) {
+        std::cout << "Unable to detect face and extract features" << std::endl;
+        return false;
+    }
+    Benchmarks::TemplateGenerator generator{prototype, synthetic.generator};
+
+    std::cout << "Generating up to " << synthetic.maxCollectionSize << " templates of "
+              << prototype.featureVector.size() << " floats, "
+              << synthetic.maxCollectionSize * prototype.featureVector.size() * sizeof(float) / 1e9
+              << " GB of feature vectors" << std::endl;
+
+    // We are using the DatabaseManagementSystem::NONE so the collection will not persist
+    if (sdk.createLoadCollection("synthetic_collection") != ErrorCode::NO_ERROR) {
+        std::cout << "Error creating collection" << std::endl;
+        return false;
+    }
+
+    std::ofstream groundTruth{synthetic.groundTruthPath};
+    groundTruth << "UUID, Identity, Template\n";
+    std::ofstream accuracy{"identification_accuracy.csv"};
+    accuracy << "Collection Size, Identities, Templates per Identity, Mated Probes, "
+             << "Non-mated Probes, Rank-1 Hit Rate, False Positive Identification Rate, "
+             << "Mean Search Time (ms)\n";
+
+    const unsigned int templatesPerIdentity = std::max(1u, synthetic.templatesPerIdentity);
+    // The identities of the non-mated probes are never enrolled at any size
+    const uint64_t firstUnenrolledIdentity = synthetic.maxCollectionSize / templatesPerIdentity;
+    const size_t numProbes = 1000;
+
+    uint64_t numEnrolledIdentities = 0;
+    std::vector<float> center;
+    Faceprint faceprint;
+    for (size_t collectionSize = 1000; collectionSize <= synthetic.maxCollectionSize;
+         collectionSize *= 10) {
+        std::cout << "Populating collection with " << collectionSize << " templates" << std::endl;
+
+        // Only the identities missing from the previous size are enrolled
+        const uint64_t numIdentities = std::max<uint64_t>(1, collectionSize / templatesPerIdentity);
+        auto enrollmentStopwatch = preciseStopwatch();
+        for (; numEnrolledIdentities < numIdentities; ++numEnrolledIdentities) {
+            const auto identity = numEnrolledIdentities;
+            const auto identityName = Benchmarks::TemplateGenerator::getIdentityName(identity);
+            generator.generateIdentity(identity, center);
+            for (unsigned int sample = 0; sample < templatesPerIdentity; ++sample) {
+                generator.generateTemplate(center, identity, sample, faceprint);
+                std::string UUID;
+                if (sdk.enrollFaceprint(faceprint, identityName, UUID) != ErrorCode::NO_ERROR) {
+                    std::cout << "Unable to enroll template" << std::endl;
+                    return false;
+                }
+                groundTruth << UUID << ",\"" << identityName << "\"," << sample << "\n";
+            }
+        }
+        std::cout << "Generated and enrolled "
+                  << collectionSize /
+                         (enrollmentStopwatch.elapsedTime<float, std::chrono::microseconds>() /
+                          1e6f)
+                  << " templates/s" << std::endl;
+
+        // The probes are templates the generator has not produced for the enrollment
+        std::mt19937_64 engine{synthetic.generator.seed + collectionSize};
+        std::uniform_int_distribution<uint64_t> enrolledIdentities{0, numIdentities - 1};
+        std::vector<Faceprint> probes(2 * numProbes);
+        std::vector<uint64_t> probeIdentities(2 * numProbes);
+        for (size_t i = 0; i < probes.size(); ++i) {
+            const bool isMated = i < numProbes;
+            probeIdentities[i] =
+                isMated ? enrolledIdentities(engine) : firstUnenrolledIdentity + i - numProbes;
+            generator.generateIdentity(probeIdentities[i], center);
+            generator.generateTemplate(center, probeIdentities[i], templatesPerIdentity + i,
+                                       probes[i]);
+        }
+
+        auto parameters = Benchmarks::Parameters{false, 0, 1, 0, 1, {}, {}, {0, true}, {}, {}};
+        parameters.numIterations = probes.size();
+        std::vector<float> times;
+        times.reserve(probes.size());
+        size_t numHits = 0;
+        size_t numFalsePositives = 0;
+        for (size_t i = 0; i < probes.size(); ++i) {
+            Candidate candidate;
+            bool found = false;
             auto stopwatch = preciseStopwatch();
-            sdk.batchIdentifyTopCandidate(probeFaceprints, candidates, foundCandidates);
+            sdk.identifyTopCandidate(probes[i], candidate, found);
             times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+
+            if (i < numProbes) {
+                numHits += found && candidate.identity == Benchmarks::TemplateGenerator::
+                                                              getIdentityName(probeIdentities[i]);
+            } else {
+                numFalsePositives += found;
+            }
         }
 
-        benchmarkName = "1 to N batch identification search";
+        const std::string benchmarkName = "1 to N identification search";
+        const std::string benchmarkSubType =
+            "(" + std::to_string(collectionSize) + ") TFV7 synthetic";
         observations.emplace_back(sdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
-                                  benchmarkSubType, parameters, times, 0.0f);
+                                  benchmarkSubType, parameters, times,
+                                  Benchmarks::MemoryProfile{});
+
+        const float hitRate = static_cast<float>(numHits) / numProbes;
+        const float falsePositiveRate = static_cast<float>(numFalsePositives) / numProbes;
+        std::cout << "Rank-1 hit rate: " << hitRate * 100.f
+                  << "% | false positive identification rate: " << falsePositiveRate * 100.f
+                  << "%" << std::endl;
+        accuracy << collectionSize << "," << numIdentities << "," << templatesPerIdentity << ","
+                 << numProbes << "," << numProbes << "," << hitRate << "," << falsePositiveRate
+                 << "," << observations.back().getTimeResult().mean << "\n";
+    }
+
+    return true;
+}
+
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program
+              << " [--synthetic] [--max-collection-size N] [--templates-per-identity N]"
+                 " [--clusters N] [--seed N] [--ground-truth PATH] [--collection-load]"
+                 " [--sqlite PATH] [--postgres CONNECTION] [--encryption-key KEY]"
+                 " [--load-repetitions N] [--mixed-workload] [--collection-size N]"
+                 " [--search-qps N] [--enroll-rate N] [--removal-rate N] [--duration SECONDS]"
+              << std::endl;
+    std::cout << "  --synthetic  instead of enrolling the same few templates, grow a collection of "
+                 "distinct synthetic templates and measure the rank-1 hit rate at every size"
+              << std::endl;
+    std::cout << "  --max-collection-size N  largest synthetic collection (default 10000000)"
+              << std::endl;
+    std::cout << "  --templates-per-identity N  synthetic templates enrolled per identity "
+                 "(default 2)"
+              << std::endl;
+    std::cout << "  --clusters N  number of clusters the synthetic identities are drawn around, 0 "
+                 "for independent identities (default 100)"
+              << std::endl;
+    std::cout << "  --seed N  seed of the synthetic templates (default 1)" << std::endl;
+    std::cout << "  --ground-truth PATH  file the identity of every enrolled synthetic template is "
+                 "written to (default ground_truth.csv)"
+              << std::endl;
+    std::cout << "  --collection-load  instead of searching, measure how long createLoadCollection "
+                 "and loadCollections take to load persisted collections of 10K, 100K and 1M "
+                 "templates (up to --max-collection-size)"
+              << std::endl;
+    std::cout << "  --sqlite PATH  SQLite database of the collection load benchmark "
+                 "(default load_benchmark.db)"
+              << std::endl;
+    std::cout << "  --postgres CONNECTION  also benchmark PostgreSQL with this connection string, "
+                 "e.g. \"host=localhost port=5432 dbname=benchmarks user=postgres password=admin\""
+              << std::endl;
+    std::cout << "  --encryption-key KEY  key of the encrypted collections" << std::endl;
+    std::cout << "  --load-repetitions N  loads measured per configuration (default 3)"
+              << std::endl;
+    std::cout << "  --mixed-workload  instead of the search benchmarks, search a collection at a "
+                 "fixed rate, first alone and then while templates are enrolled and removed"
+              << std::endl;
+    std::cout << "  --collection-size N  templates in the mixed workload collection "
+                 "(default 1000000)"
+              << std::endl;
+    std::cout << "  --search-qps N  searches per second of the mixed workload (default 100)"
+              << std::endl;
+    std::cout << "  --enroll-rate N  enrollments per second of the mixed workload, 0 to disable "
+                 "(default 100)"
+              << std::endl;
+    std::cout << "  --removal-rate N  removals per second of the mixed workload, 0 to disable "
+                 "(default 10)"
+              << std::endl;
+    std::cout << "  --duration SECONDS  duration of each phase of the mixed workload (default 30)"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    // The identities of a cluster have a similarity of about 0.2, and the templates of an
+    // identity a similarity of about 0.75
+    SyntheticOptions synthetic{false, 10000000, 2, {100, 2.f, 0.6f, 1}, "ground_truth.csv"};
+    bool collectionLoad = false;
+    Benchmarks::CollectionLoadOptions loadOptions{
+        "load_benchmark.db", "", "benchmark encryption key", {10000, 100000, 1000000}, 3, {}};
+    bool mixedWorkload = false;
+    Benchmarks::MixedWorkloadOptions mixedOptions{1000000, 100.f, 100.f, 10.f, 30.f, {}};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--synthetic") == 0) {
+            synthetic.enabled = true;
+        } else if (std::strcmp(argv[i], "--max-collection-size") == 0 && i + 1 < argc) {
+            synthetic.maxCollectionSize = std::stoull(argv[++i]);
+        } else if (std::strcmp(argv[i], "--templates-per-identity") == 0 && i + 1 < argc) {
+            synthetic.templatesPerIdentity = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--clusters") == 0 && i + 1 < argc) {
+            synthetic.generator.numClusters = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            synthetic.generator.seed = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--ground-truth") == 0 && i + 1 < argc) {
+            synthetic.groundTruthPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--collection-load") == 0) {
+            collectionLoad = true;
+        } else if (std::strcmp(argv[i], "--sqlite") == 0 && i + 1 < argc) {
+            loadOptions.sqlitePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--postgres") == 0 && i + 1 < argc) {
+            loadOptions.postgresConnection = argv[++i];
+        } else if (std::strcmp(argv[i], "--encryption-key") == 0 && i + 1 < argc) {
+            loadOptions.encryptionKey = argv[++i];
+        } else if (std::strcmp(argv[i], "--load-repetitions") == 0 && i + 1 < argc) {
+            loadOptions.numRepetitions = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--mixed-workload") == 0) {
+            mixedWorkload = true;
+        } else if (std::strcmp(argv[i], "--collection-size") == 0 && i + 1 < argc) {
+            mixedOptions.collectionSize = std::stoull(argv[++i]);
+        } else if (std::strcmp(argv[i], "--search-qps") == 0 && i + 1 < argc) {
+            mixedOptions.searchesPerSecond = std::stof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--enroll-rate") == 0 && i + 1 < argc) {
+            mixedOptions.enrollmentsPerSecond = std::stof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--removal-rate") == 0 && i + 1 < argc) {
+            mixedOptions.removalsPerSecond = std::stof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            mixedOptions.duration = std::stof(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto gpuOptions = GPUOptions(false);
+    auto sdkFactory = Benchmarks::SDKFactory(gpuOptions);
+
+    auto observations = Benchmarks::ObservationList();
+    if (collectionLoad) {
+        // The load benchmark forks before loading the SDK, so it runs on its own
+        loadOptions.generator = synthetic.generator;
+        loadOptions.collectionSizes.erase(
+            std::remove_if(loadOptions.collectionSizes.begin(), loadOptions.collectionSizes.end(),
+                           [&](size_t size) { return size > synthetic.maxCollectionSize; }),
+            loadOptions.collectionSizes.end());
+        Benchmarks::runCollectionLoadBenchmark(sdkFactory, loadOptions, observations);
+    } else if (mixedWorkload) {
+        mixedOptions.generator = synthetic.generator;
+        Benchmarks::runMixedWorkloadBenchmark(sdkFactory, mixedOptions, observations);
+    } else if (synthetic.enabled) {
+        if (!benchmarkSyntheticIdentification(sdkFactory, synthetic, observations)) {
+            return -1;
+        }
+    } else {
+        // Benchmark with and without vector compression, which trades accuracy for a smaller and
+        // faster to search collection
+        std::vector<TemplateMemory> templateMemory[2];
+        for (bool frVectorCompression : {false, true}) {
+            // in children, before this process loads the SDK
+            if (!measureTemplateMemory(sdkFactory, frVectorCompression,
+                                       templateMemory[frVectorCompression])) {
+                std::cout << "Measuring the memory of the templates in the benchmark process, "
+                             "the memory freed with the previous collections may hide it"
+                          << std::endl;
+                templateMemory[0].clear();
+                templateMemory[1].clear();
+                break;
+            }
+        }
+        for (bool frVectorCompression : {false, true}) {
+            if (!benchmarkIdentification(sdkFactory, frVectorCompression,
+                                         templateMemory[frVectorCompression], observations)) {
+                return -1;
+            }
+        }
+    }
+
+    if (observations.empty()) {
+        return -1;
     }
 
-    auto csvWriter = Benchmarks::ObservationCSVWriter("benchmarks.csv");
+    auto csvWriter = Benchmarks::ObservationCSVWriter(
+        "benchmarks.csv", Benchmarks::HostInfo::detect(observations.front().getVersion()));
     csvWriter.write(observations);
 
     return 0;
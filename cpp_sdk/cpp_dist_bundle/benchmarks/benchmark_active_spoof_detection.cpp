@@ -0,0 +1,108 @@
+#include "fixture.h"
+#include "observation.h"
+#include "registry.h"
+#include "runner.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <iostream>
+
+using namespace Trueface;
+using namespace Trueface::Benchmarks;
+
+const std::string benchmarkName{"Active spoof detection"};
+
+namespace {
+
+const std::string nearImagePath{"../../images/near_shot_real_person.jpg"};
+const std::string farImagePath{"../../images/far_shot_real_person.jpg"};
+
+// The size check fails on purpose when the face is too close or too far, which is a verdict
+// rather than an error of the call
+ErrorCode checkFaceSize(SDK &tfSdk, const TFImage &img, const FaceBoxAndLandmarks &faceBox,
+                        ActiveSpoofStage stage) {
+    auto errorCode = tfSdk.checkSpoofImageFaceSize(img, faceBox, stage);
+    if (errorCode == ErrorCode::FACE_TOO_FAR || errorCode == ErrorCode::FACE_TOO_CLOSE) {
+        return ErrorCode::NO_ERROR;
+    }
+    return errorCode;
+}
+
+void benchmarkSpoofImageFaceSize(Fixture &fixture, ActiveSpoofStage stage, Parameters params,
+                                 ObservationList &observations) {
+    // Initialize the SDK
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    options.initializeModule.faceDetector = true;
+
+    const std::string &imagePath = stage == ActiveSpoofStage::NEAR ? nearImagePath : farImagePath;
+    auto prepare = [&fixture, &options, &imagePath, stage](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, imagePath, face)) {
+            return false;
+        }
+
+        const TFImage img = face.image;
+        const FaceBoxAndLandmarks faceBoxAndLandmarks = face.faceBoxAndLandmarks;
+        inference = [&tfSdk, img, faceBoxAndLandmarks, stage]() {
+            return checkFaceSize(tfSdk, img, faceBoxAndLandmarks, stage);
+        };
+        return true;
+    };
+
+    const std::string subType = stage == ActiveSpoofStage::NEAR ? "checkSpoofImageFaceSize, near"
+                                                                : "checkSpoofImageFaceSize, far";
+    runBenchmark(fixture, options, benchmarkName, subType, prepare, params, observations);
+}
+
+void benchmarkActiveSpoof(Fixture &fixture, Parameters params, ObservationList &observations) {
+    // Initialize the SDK
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    options.initializeModule.faceDetector = true;
+    options.initializeModule.landmarkDetector = true;
+    options.initializeModule.activeSpoof = true;
+
+    auto prepare = [&fixture, &options](SDK &tfSdk, Inference &inference) {
+        FaceInput nearFace;
+        FaceInput farFace;
+        if (!fixture.getLargestFace(tfSdk, options, nearImagePath, nearFace) ||
+            !fixture.getLargestFace(tfSdk, options, farImagePath, farFace)) {
+            return false;
+        }
+
+        Landmarks nearFaceLandmarks{};
+        Landmarks farFaceLandmarks{};
+        if (tfSdk.getFaceLandmarks(nearFace.image, nearFace.faceBoxAndLandmarks,
+                                   nearFaceLandmarks) != ErrorCode::NO_ERROR ||
+            tfSdk.getFaceLandmarks(farFace.image, farFace.faceBoxAndLandmarks,
+                                   farFaceLandmarks) != ErrorCode::NO_ERROR) {
+            std::cout << "Unable to detect landmarks" << std::endl;
+            return false;
+        }
+
+        float spoofScore{};
+        SpoofLabel spoofLabel{};
+        inference = [&tfSdk, nearFaceLandmarks, farFaceLandmarks, spoofScore,
+                     spoofLabel]() mutable {
+            return tfSdk.detectActiveSpoof(nearFaceLandmarks, farFaceLandmarks, spoofScore,
+                                           spoofLabel);
+        };
+        return true;
+    };
+
+    runBenchmark(fixture, options, benchmarkName, "detectActiveSpoof", prepare, params,
+                 observations);
+}
+
+void runActiveSpoofDetection(Fixture &fixture, const SuiteContext &suite,
+                             ObservationList &observations) {
+    for (auto stage : {ActiveSpoofStage::FAR, ActiveSpoofStage::NEAR}) {
+        benchmarkSpoofImageFaceSize(fixture, stage, suite.params(1, 500 * suite.multFactor),
+                                    observations);
+    }
+    benchmarkActiveSpoof(fixture, suite.params(1, 500 * suite.multFactor), observations);
+}
+
+const BenchmarkRegistration registration{benchmarkName, runActiveSpoofDetection};
+
+} // namespace
@@ -1,7 +1,7 @@
-#include "memory_high_water_mark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -13,70 +13,52 @@ using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"Blink detection"};
 
-void benchmarkBlinkDetection(const SDKFactory &sdkFactory, Parameters params,
-                             ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkBlinkDetection(Fixture &fixture, Parameters params, ObservationList &observations) {
     // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.initializeModule.faceDetector = true;
     options.initializeModule.blinkDetector = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/headshot.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
-
-    FaceBoxAndLandmarks faceBoxAndLandmarks;
-    bool found = false;
-    errorCode = tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
+    auto prepare = [&fixture, &options, &params](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/headshot.jpg", face)) {
+            return false;
+        }
 
-    if (errorCode != ErrorCode::NO_ERROR || !found) {
-        std::cout << "Unable to detect face in image" << std::endl;
-        return;
-    }
+        Landmarks landmarks;
+        ErrorCode errorCode =
+            tfSdk.getFaceLandmarks(face.image, face.faceBoxAndLandmarks, landmarks);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            std::cout << "Unable to get face landmarks in image" << std::endl;
+            return false;
+        }
 
-    Landmarks landmarks;
-    errorCode = tfSdk.getFaceLandmarks(img, faceBoxAndLandmarks, landmarks);
-    if (errorCode != ErrorCode::NO_ERROR || !found) {
-        std::cout << "Unable to get face landmarks in image" << std::endl;
-        return;
-    }
+        std::vector<TFImage> tfImages;
+        std::vector<Landmarks> landmarksVec;
+        for (size_t i = 0; i < params.batchSize; ++i) {
+            tfImages.push_back(face.image);
+            landmarksVec.push_back(landmarks);
+        }
 
-    std::vector<TFImage> tfImages;
-    std::vector<Landmarks> landmarksVec;
-    for (size_t i = 0; i < params.batchSize; ++i) {
-        tfImages.push_back(img);
-        landmarksVec.push_back(landmarks);
-    }
+        std::vector<BlinkState> blinkstates;
+        inference = [&tfSdk, tfImages, landmarksVec, blinkstates]() mutable {
+            return tfSdk.detectBlinks(tfImages, landmarksVec, blinkstates);
+        };
+        return true;
+    };
 
-    std::vector<BlinkState> blinkstates;
+    runBenchmark(fixture, options, benchmarkName, "", prepare, params, observations);
+}
 
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.detectBlinks(tfImages, landmarksVec, blinkstates);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Error: Unable to run blink detection" << std::endl;
-                return;
-            }
-        }
+void runBlinkDetection(Fixture &fixture, const SuiteContext &suite, ObservationList &observations) {
+    for (auto batchSize : suite.batchSizes) {
+        benchmarkBlinkDetection(fixture, suite.params(batchSize, 100 * suite.multFactor),
+                                observations);
     }
+}
 
-    // Time the blink detector
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.detectBlinks(tfImages, landmarksVec, blinkstates);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
+const BenchmarkRegistration registration{benchmarkName, runBlinkDetection};
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, "",
-                              params, times, memoryTracker.getDifferenceFromBaseline());
-}
+} // namespace
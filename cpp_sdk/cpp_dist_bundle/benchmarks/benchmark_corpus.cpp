@@ -0,0 +1,267 @@
+// Benchmarks face detection, alignment and recognition over a directory of real images.
+// The images are bucketed by resolution and by the number of detected faces, so the latency
+// of crowded high resolution scenes is reported separately from single headshots.
+
+#include "observation.h"
+#include "runner.h"
+#include "sdkfactory.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+using namespace Trueface;
+using namespace Trueface::Benchmarks;
+
+namespace {
+
+const std::string detectionBenchmarkName{"Corpus face detection"};
+const std::string alignmentBenchmarkName{"Corpus aligned face extraction"};
+const std::string recognitionBenchmarkName{"Corpus face recognition"};
+
+bool isImageFile(const std::string &path) {
+    const auto dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == "jpg" || extension == "jpeg" || extension == "png" || extension == "bmp";
+}
+
+// Recursively collects the image files below directory
+void findImages(const std::string &directory, std::vector<std::string> &imagePaths) {
+#if !defined(WIN32) && !defined(_WIN32)
+    DIR *dir = opendir(directory.c_str());
+    if (!dir) {
+        std::cout << "Error: could not open the directory " << directory << std::endl;
+        return;
+    }
+    while (dirent *entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        const std::string path = directory + "/" + name;
+        struct stat status;
+        if (stat(path.c_str(), &status) != 0) {
+            continue;
+        }
+        if (S_ISDIR(status.st_mode)) {
+            findImages(path, imagePaths);
+        } else if (S_ISREG(status.st_mode) && isImageFile(path)) {
+            imagePaths.push_back(path);
+        }
+    }
+    closedir(dir);
+#else
+    (void)directory;
+    (void)imagePaths;
+    std::cout << "Error: the corpus benchmark is not supported on Windows" << std::endl;
+#endif
+}
+
+// Buckets by the short side of the image, so portrait and landscape images are treated alike
+int getResolutionBucket(int width, int height) {
+    const int shortSide = std::min(width, height);
+    if (shortSide <= 480) {
+        return 0;
+    } else if (shortSide <= 720) {
+        return 1;
+    } else if (shortSide <= 1080) {
+        return 2;
+    } else if (shortSide <= 1440) {
+        return 3;
+    }
+    return 4;
+}
+
+const char *getResolutionBucketName(int bucket) {
+    static const char *names[] = {"up to 480p", "720p", "1080p", "1440p", "4K and above"};
+    return names[bucket];
+}
+
+int getFaceCountBucket(size_t numFaces) {
+    if (numFaces <= 1) {
+        return static_cast<int>(numFaces);
+    } else if (numFaces <= 5) {
+        return 2;
+    } else if (numFaces <= 20) {
+        return 3;
+    }
+    return 4;
+}
+
+const char *getFaceCountBucketName(int bucket) {
+    static const char *names[] = {"0 faces", "1 face", "2-5 faces", "6-20 faces", "21+ faces"};
+    return names[bucket];
+}
+
+// (resolution bucket, face count bucket)
+using Bucket = std::pair<int, int>;
+
+// The preprocessed images of one bucket along with the faces detected in each of them
+struct BucketImages {
+    std::vector<TFImage> images;
+    std::vector<std::vector<FaceBoxAndLandmarks>> faces;
+};
+
+bool loadBucket(SDK &tfSdk, const std::vector<std::string> &imagePaths, BucketImages &bucket) {
+    for (const auto &path : imagePaths) {
+        TFImage img;
+        ErrorCode errorCode = tfSdk.preprocessImage(path, img);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            std::cout << "Error: could not load the image " << path << std::endl;
+            return false;
+        }
+        std::vector<FaceBoxAndLandmarks> faces;
+        errorCode = tfSdk.detectFaces(img, faces);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            std::cout << "Error: unable to detect faces in " << path << std::endl;
+            return false;
+        }
+        bucket.images.push_back(img);
+        bucket.faces.push_back(faces);
+    }
+    return true;
+}
+
+} // namespace
+
+void benchmarkCorpus(const SDKFactory &sdkFactory, const std::string &corpusPath,
+                     Parameters params, ObservationList &observations) {
+    std::vector<std::string> imagePaths;
+    findImages(corpusPath, imagePaths);
+    if (imagePaths.empty()) {
+        std::cout << "Error: no images found in " << corpusPath << std::endl;
+        return;
+    }
+    std::sort(imagePaths.begin(), imagePaths.end());
+
+    auto options = sdkFactory.createBasicConfiguration();
+    options.initializeModule.faceDetector = true;
+    options.initializeModule.faceRecognizer = true;
+
+    // Bucket the corpus by resolution and by the number of faces found by the detector
+    std::map<Bucket, std::vector<std::string>> buckets;
+    {
+        auto tfSdk = sdkFactory.createSDK(options);
+        for (const auto &path : imagePaths) {
+            TFImage img;
+            std::vector<FaceBoxAndLandmarks> faces;
+            if (tfSdk.preprocessImage(path, img) != ErrorCode::NO_ERROR ||
+                tfSdk.detectFaces(img, faces) != ErrorCode::NO_ERROR) {
+                std::cout << "Skipping " << path << ": could not detect faces" << std::endl;
+                continue;
+            }
+            const Bucket bucket{getResolutionBucket(img->getWidth(), img->getHeight()),
+                                getFaceCountBucket(faces.size())};
+            buckets[bucket].push_back(path);
+            std::cout << path << ": " << img->getWidth() << "x" << img->getHeight() << ", "
+                      << faces.size() << " faces" << std::endl;
+        }
+    }
+
+    for (const auto &bucket : buckets) {
+        const auto &bucketPaths = bucket.second;
+        std::ostringstream subType;
+        subType << getResolutionBucketName(bucket.first.first) << ", "
+                << getFaceCountBucketName(bucket.first.second) << " (" << bucketPaths.size()
+                << (bucketPaths.size() == 1 ? " image)" : " images)");
+
+        // Each inference processes the next image of the bucket
+        auto prepareDetection = [&bucketPaths](SDK &tfSdk, Inference &inference) {
+            BucketImages bucketImages;
+            if (!loadBucket(tfSdk, bucketPaths, bucketImages)) {
+                return false;
+            }
+            std::vector<FaceBoxAndLandmarks> faces;
+            size_t next = 0;
+            inference = [&tfSdk, bucketImages, faces, next]() mutable {
+                const auto &img = bucketImages.images[next++ % bucketImages.images.size()];
+                return tfSdk.detectFaces(img, faces);
+            };
+            return true;
+        };
+
+        runBenchmark(sdkFactory, options, detectionBenchmarkName, subType.str(), prepareDetection,
+                     params, observations);
+
+        // There is nothing to align or recognize without faces
+        if (bucket.first.second == 0) {
+            continue;
+        }
+
+        // Aligns every face of the image
+        auto prepareAlignment = [&bucketPaths](SDK &tfSdk, Inference &inference) {
+            BucketImages bucketImages;
+            if (!loadBucket(tfSdk, bucketPaths, bucketImages)) {
+                return false;
+            }
+            std::vector<TFFacechip> facechips;
+            size_t next = 0;
+            inference = [&tfSdk, bucketImages, facechips, next]() mutable {
+                const size_t i = next++ % bucketImages.images.size();
+                const auto &faces = bucketImages.faces[i];
+                facechips.resize(faces.size());
+                for (size_t j = 0; j < faces.size(); ++j) {
+                    auto errorCode =
+                        tfSdk.extractAlignedFace(bucketImages.images[i], faces[j], facechips[j]);
+                    if (errorCode != ErrorCode::NO_ERROR) {
+                        return errorCode;
+                    }
+                }
+                return ErrorCode::NO_ERROR;
+            };
+            return true;
+        };
+
+        runBenchmark(sdkFactory, options, alignmentBenchmarkName, subType.str(), prepareAlignment,
+                     params, observations);
+
+        // Extracts the templates of all the faces of the image in a single call
+        auto prepareRecognition = [&bucketPaths](SDK &tfSdk, Inference &inference) {
+            BucketImages bucketImages;
+            if (!loadBucket(tfSdk, bucketPaths, bucketImages)) {
+                return false;
+            }
+            std::vector<std::vector<TFFacechip>> facechips(bucketImages.images.size());
+            for (size_t i = 0; i < bucketImages.images.size(); ++i) {
+                for (const auto &face : bucketImages.faces[i]) {
+                    TFFacechip facechip;
+                    ErrorCode errorCode =
+                        tfSdk.extractAlignedFace(bucketImages.images[i], face, facechip);
+                    if (errorCode != ErrorCode::NO_ERROR) {
+                        std::cout << "Error: unable to extract aligned face" << std::endl;
+                        return false;
+                    }
+                    facechips[i].push_back(facechip);
+                }
+            }
+            std::vector<Faceprint> faceprints;
+            size_t next = 0;
+            inference = [&tfSdk, facechips, faceprints, next]() mutable {
+                return tfSdk.getFaceFeatureVectors(facechips[next++ % facechips.size()],
+                                                   faceprints);
+            };
+            return true;
+        };
+
+        runBenchmark(sdkFactory, options, recognitionBenchmarkName, subType.str(),
+                     prepareRecognition, params, observations);
+    }
+}
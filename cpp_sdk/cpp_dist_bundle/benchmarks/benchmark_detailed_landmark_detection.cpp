@@ -1,7 +1,7 @@
-#include "memory_high_water_mark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -13,61 +13,45 @@ using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"106 face landmark detection"};
 
-void benchmarkDetailedLandmarkDetection(const SDKFactory &sdkFactory, Parameters params,
-                                        ObservationList &observations) {
-    // baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkDetailedLandmarkDetection(Fixture &fixture, Parameters params,
+                                        ObservationList &observations) {
     // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.initializeModule.landmarkDetector = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/headshot.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
+    auto prepare = [&fixture, &options, &params](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/headshot.jpg", face)) {
+            return false;
+        }
 
-    FaceBoxAndLandmarks faceBoxAndLandmarks;
-    bool found = false;
-    errorCode = tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
+        std::vector<FaceBoxAndLandmarks> fbs;
+        std::vector<TFImage> tfImages;
+        for (size_t i = 0; i < params.batchSize; ++i) {
+            fbs.push_back(face.faceBoxAndLandmarks);
+            tfImages.push_back(face.image);
+        }
 
-    if (errorCode != ErrorCode::NO_ERROR || !found) {
-        std::cout << "Unable to detect face in image" << std::endl;
-        return;
-    }
+        std::vector<Landmarks> landmarksVec;
+        inference = [&tfSdk, tfImages, fbs, landmarksVec]() mutable {
+            return tfSdk.getFaceLandmarks(tfImages, fbs, landmarksVec);
+        };
+        return true;
+    };
 
-    std::vector<FaceBoxAndLandmarks> fbs;
-    std::vector<TFImage> tfImages;
-    for (size_t i = 0; i < params.batchSize; ++i) {
-        fbs.push_back(faceBoxAndLandmarks);
-        tfImages.push_back(img);
-    }
+    runBenchmark(fixture, options, benchmarkName, "", prepare, params, observations);
+}
 
-    std::vector<Landmarks> landmarksVec;
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.getFaceLandmarks(tfImages, fbs, landmarksVec);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Error: Unable to get detailed landmarks" << std::endl;
-                return;
-            }
-        }
+void runDetailedLandmarkDetection(Fixture &fixture, const SuiteContext &suite,
+                                  ObservationList &observations) {
+    for (auto batchSize : suite.batchSizes) {
+        benchmarkDetailedLandmarkDetection(
+            fixture, suite.params(batchSize, 100 * suite.multFactor), observations);
     }
+}
 
-    // Time the landmark detection
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.getFaceLandmarks(tfImages, fbs, landmarksVec);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
+const BenchmarkRegistration registration{benchmarkName, runDetailedLandmarkDetection};
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, "",
-                              params, times, memoryTracker.getDifferenceFromBaseline());
-}
+} // namespace
@@ -0,0 +1,105 @@
+#include "fixture.h"
+#include "observation.h"
+#include "registry.h"
+#include "runner.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <iostream>
+
+using namespace Trueface;
+using namespace Trueface::Benchmarks;
+
+const std::string benchmarkName{"Drawing"};
+
+namespace {
+
+// The drawing calls write into the image, so they draw on a copy of the pixels rather than on the
+// image shared by the fixture
+bool copyImage(SDK &tfSdk, const TFImage &img, TFImage &copy) {
+    if (tfSdk.preprocessImage(img->getData(), img->getWidth(), img->getHeight(), ColorCode::rgb,
+                              copy) != ErrorCode::NO_ERROR) {
+        std::cout << "Error: could not copy the image" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void benchmarkDrawObjectLabels(Fixture &fixture, Parameters params,
+                               ObservationList &observations) {
+    // Initialize the SDK
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    options.initializeModule.objectDetector = true;
+
+    auto prepare = [&fixture](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        if (!fixture.getImage(tfSdk, "../images/bike.jpg", img)) {
+            return false;
+        }
+
+        std::vector<BoundingBox> boundingBoxes;
+        if (tfSdk.detectObjects(img, boundingBoxes) != ErrorCode::NO_ERROR) {
+            std::cout << "Unable to detect objects" << std::endl;
+            return false;
+        }
+
+        TFImage canvas;
+        if (!copyImage(tfSdk, img, canvas)) {
+            return false;
+        }
+        inference = [&tfSdk, canvas, boundingBoxes]() mutable {
+            return tfSdk.drawObjectLabels(canvas, boundingBoxes);
+        };
+        return true;
+    };
+
+    runBenchmark(fixture, options, benchmarkName, "drawObjectLabels", prepare, params,
+                 observations);
+}
+
+void benchmarkDrawHeadOrientationBox(Fixture &fixture, Parameters params,
+                                     ObservationList &observations) {
+    // Initialize the SDK
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    options.initializeModule.faceDetector = true;
+
+    auto prepare = [&fixture, &options](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/headshot.jpg", face)) {
+            return false;
+        }
+
+        Landmarks landmarks;
+        HeadOrientation headOrientation;
+        if (tfSdk.getFaceLandmarks(face.image, face.faceBoxAndLandmarks, landmarks) !=
+                ErrorCode::NO_ERROR ||
+            tfSdk.estimateHeadOrientation(face.image, face.faceBoxAndLandmarks, landmarks,
+                                          headOrientation) != ErrorCode::NO_ERROR) {
+            std::cout << "Unable to estimate the head orientation" << std::endl;
+            return false;
+        }
+
+        TFImage canvas;
+        if (!copyImage(tfSdk, face.image, canvas)) {
+            return false;
+        }
+        inference = [&tfSdk, canvas, headOrientation]() mutable {
+            return tfSdk.drawHeadOrientationBox(canvas, headOrientation);
+        };
+        return true;
+    };
+
+    runBenchmark(fixture, options, benchmarkName, "drawHeadOrientationBox", prepare, params,
+                 observations);
+}
+
+void runDrawing(Fixture &fixture, const SuiteContext &suite, ObservationList &observations) {
+    benchmarkDrawObjectLabels(fixture, suite.params(1, 200 * suite.multFactor), observations);
+    benchmarkDrawHeadOrientationBox(fixture, suite.params(1, 200 * suite.multFactor),
+                                    observations);
+}
+
+const BenchmarkRegistration registration{benchmarkName, runDrawing};
+
+} // namespace
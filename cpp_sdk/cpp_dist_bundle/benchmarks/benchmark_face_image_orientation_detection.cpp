@@ -1,7 +1,7 @@
-#include "memory_high_water_mark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -13,51 +13,43 @@ using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"Face image orientation detection"};
 
-void benchmarkFaceImageOrientationDetection(const SDKFactory &sdkFactory, Parameters params,
-                                            ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkFaceImageOrientationDetection(Fixture &fixture, Parameters params,
+                                            ObservationList &observations) {
     // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.initializeModule.faceOrientationDetector = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/headshot.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
-
-    std::vector<TFImage> tfImages;
-    for (size_t i = 0; i < params.batchSize; ++i) {
-        tfImages.push_back(img);
-    }
-
-    std::vector<RotateFlags> flags;
+    auto prepare = [&fixture, &params](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        if (!fixture.getImage(tfSdk, "../images/headshot.jpg", img)) {
+            return false;
+        }
 
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.getFaceImageRotations(tfImages, flags);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Error: Unable to compute face image orientation" << std::endl;
-                return;
-            }
+        std::vector<TFImage> tfImages;
+        for (size_t i = 0; i < params.batchSize; ++i) {
+            tfImages.push_back(img);
         }
-    }
 
-    // Time the image rotation detector
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.getFaceImageRotations(tfImages, flags);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+        std::vector<RotateFlags> flags;
+        inference = [&tfSdk, tfImages, flags]() mutable {
+            return tfSdk.getFaceImageRotations(tfImages, flags);
+        };
+        return true;
+    };
+
+    runBenchmark(fixture, options, benchmarkName, "", prepare, params, observations);
+}
+
+void runFaceImageOrientationDetection(Fixture &fixture, const SuiteContext &suite,
+                                      ObservationList &observations) {
+    for (auto batchSize : suite.batchSizes) {
+        benchmarkFaceImageOrientationDetection(
+            fixture, suite.params(batchSize, 50 * suite.multFactor), observations);
     }
+}
+
+const BenchmarkRegistration registration{benchmarkName, runFaceImageOrientationDetection};
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, "",
-                              params, times, memoryTracker.getDifferenceFromBaseline());
-}
\ No newline at end of file
+} // namespace
@@ -0,0 +1,82 @@
+#include "fixture.h"
+#include "observation.h"
+#include "registry.h"
+#include "runner.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <iostream>
+
+using namespace Trueface;
+using namespace Trueface::Benchmarks;
+
+const std::string benchmarkName{"Face image quality"};
+
+namespace {
+
+void benchmarkFaceImageExposure(Fixture &fixture, Parameters params,
+                                ObservationList &observations) {
+    // Initialize the SDK
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    options.initializeModule.faceDetector = true;
+
+    auto prepare = [&fixture, &options](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/headshot.jpg", face)) {
+            return false;
+        }
+
+        const TFImage img = face.image;
+        const FaceBoxAndLandmarks faceBoxAndLandmarks = face.faceBoxAndLandmarks;
+        FaceImageQuality quality{};
+        float percentImageBright{};
+        float percentFaceBright{};
+        float percentFaceDark{};
+        inference = [&tfSdk, img, faceBoxAndLandmarks, quality, percentImageBright,
+                     percentFaceBright, percentFaceDark]() mutable {
+            return tfSdk.checkFaceImageExposure(img, faceBoxAndLandmarks, quality,
+                                                percentImageBright, percentFaceBright,
+                                                percentFaceDark);
+        };
+        return true;
+    };
+
+    runBenchmark(fixture, options, benchmarkName, "checkFaceImageExposure", prepare, params,
+                 observations);
+}
+
+void benchmarkFaceImageQuality(Fixture &fixture, Parameters params,
+                               ObservationList &observations) {
+    // Initialize the SDK
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    options.initializeModule.faceDetector = true;
+    options.initializeModule.faceRecognizer = true;
+
+    auto prepare = [&fixture, &options](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/headshot.jpg", face)) {
+            return false;
+        }
+
+        const TFFacechip facechip = face.facechip;
+        float quality{};
+        inference = [&tfSdk, facechip, quality]() mutable {
+            return tfSdk.estimateFaceImageQuality(facechip, quality);
+        };
+        return true;
+    };
+
+    runBenchmark(fixture, options, benchmarkName, "estimateFaceImageQuality", prepare, params,
+                 observations);
+}
+
+void runFaceImageQuality(Fixture &fixture, const SuiteContext &suite,
+                         ObservationList &observations) {
+    benchmarkFaceImageExposure(fixture, suite.params(1, 200 * suite.multFactor), observations);
+    benchmarkFaceImageQuality(fixture, suite.params(1, 200 * suite.multFactor), observations);
+}
+
+const BenchmarkRegistration registration{benchmarkName, runFaceImageQuality};
+
+} // namespace
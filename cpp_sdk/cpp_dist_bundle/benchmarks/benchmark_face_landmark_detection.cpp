@@ -1,7 +1,7 @@
-#include "memory_high_water_mark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -13,47 +13,37 @@ using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"Face and landmark detection"};
 
-void benchmarkFaceLandmarkDetection(const SDKFactory &sdkFactory, Parameters params,
-                                    ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkFaceLandmarkDetection(Fixture &fixture, Parameters params,
+                                    ObservationList &observations) {
     // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.initializeModule.faceDetector = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/headshot.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
-
-    FaceBoxAndLandmarks faceBoxAndLandmarks;
-    bool found = false;
-
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Error: Unable to run face detection" << std::endl;
-                return;
-            }
+    auto prepare = [&fixture](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        if (!fixture.getImage(tfSdk, "../images/headshot.jpg", img)) {
+            return false;
         }
-    }
-
-    // Time the face detector
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
-
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, "",
-                              params, times, memoryTracker.getDifferenceFromBaseline());
-}
\ No newline at end of file
+
+        FaceBoxAndLandmarks faceBoxAndLandmarks;
+        bool found = false;
+        inference = [&tfSdk, img, faceBoxAndLandmarks, found]() mutable {
+            return tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
+        };
+        return true;
+    };
+
+    runBenchmark(fixture, options, benchmarkName, "", prepare, params, observations);
+}
+
+void runFaceLandmarkDetection(Fixture &fixture, const SuiteContext &suite,
+                              ObservationList &observations) {
+    benchmarkFaceLandmarkDetection(fixture, suite.params(1, 100 * suite.multFactor),
+                                   observations);
+}
+
+const BenchmarkRegistration registration{benchmarkName, runFaceLandmarkDetection};
+
+} // namespace
@@ -1,7 +1,8 @@
-#include "memory_high_water_mark.h"
+#include "benchmark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -29,71 +30,50 @@ std::string getModelName(FacialRecognitionModel model) {
     }
 }
 
-void benchmarkFaceRecognition(const SDKFactory &sdkFactory, FacialRecognitionModel model,
-                              Parameters params, ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkFaceRecognition(Fixture &fixture, FacialRecognitionModel model, Parameters params,
+                              ObservationList &observations) {
     // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.frModel = model;
     options.initializeModule.faceRecognizer = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/headshot.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
-
-    // Obtain the aligned chip
-    FaceBoxAndLandmarks faceBoxAndLandmarks;
-    bool found;
-    errorCode = tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: Unable to detect face when benchmarking face recognition model"
-                  << std::endl;
-        return;
-    }
+    auto prepare = [&fixture, &options, &params](SDK &tfSdk, Inference &inference) {
+        // The aligned chip
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/headshot.jpg", face)) {
+            return false;
+        }
 
-    TFFacechip facechip;
-    errorCode = tfSdk.extractAlignedFace(img, faceBoxAndLandmarks, facechip);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout
-            << "Error: Unable to extract aligned face when benchmarking face recognition model"
-            << std::endl;
-        return;
-    }
+        std::vector<TFFacechip> facechips;
+        for (size_t i = 0; i < params.batchSize; ++i) {
+            facechips.push_back(face.facechip);
+        }
 
-    std::vector<TFFacechip> facechips;
-    for (size_t i = 0; i < params.batchSize; ++i) {
-        facechips.push_back(facechip);
-    }
+        std::vector<Faceprint> faceprints;
+        inference = [&tfSdk, facechips, faceprints]() mutable {
+            return tfSdk.getFaceFeatureVectors(facechips, faceprints);
+        };
+        return true;
+    };
 
-    std::vector<Faceprint> faceprints;
+    runBenchmark(fixture, options, benchmarkName, getModelName(model), prepare, params,
+                 observations);
+}
 
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.getFaceFeatureVectors(facechips, faceprints);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Error: Unable to run face recognition" << std::endl;
-                return;
-            }
+void runFaceRecognition(Fixture &fixture, const SuiteContext &suite,
+                        ObservationList &observations) {
+    for (auto batchSize : suite.batchSizes) {
+        for (auto model : {FacialRecognitionModel::LITE_V2, FacialRecognitionModel::LITE_V3,
+                           FacialRecognitionModel::TFV5_2, FacialRecognitionModel::TFV6,
+                           FacialRecognitionModel::TFV7}) {
+            benchmarkFaceRecognition(fixture, model, suite.params(batchSize, 40 * suite.multFactor),
+                                     observations);
         }
     }
+}
 
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.getFaceFeatureVectors(facechips, faceprints);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
+const BenchmarkRegistration registration{benchmarkName, runFaceRecognition};
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
-                              getModelName(model), params, times,
-                              memoryTracker.getDifferenceFromBaseline());
-}
\ No newline at end of file
+} // namespace
@@ -1,7 +1,7 @@
-#include "memory_high_water_mark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -13,56 +13,38 @@ using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"Eyeglasses detection"};
 
-void benchmarkGlassesDetection(const SDKFactory &sdkFactory, Parameters params,
-                               ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkGlassesDetection(Fixture &fixture, Parameters params,
+                               ObservationList &observations) {
     // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.initializeModule.eyeglassDetector = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/headshot.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
-
-    FaceBoxAndLandmarks faceBoxAndLandmarks;
-    bool found = false;
-    errorCode = tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
+    auto prepare = [&fixture, &options](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/headshot.jpg", face)) {
+            return false;
+        }
 
-    if (errorCode != ErrorCode::NO_ERROR || !found) {
-        std::cout << "Unable to detect face in image" << std::endl;
-        return;
-    }
+        const TFImage img = face.image;
+        const FaceBoxAndLandmarks faceBoxAndLandmarks = face.faceBoxAndLandmarks;
+        GlassesLabel label{};
+        float score{};
+        inference = [&tfSdk, img, faceBoxAndLandmarks, label, score]() mutable {
+            return tfSdk.detectGlasses(img, faceBoxAndLandmarks, label, score);
+        };
+        return true;
+    };
 
-    GlassesLabel label;
-    float score;
+    runBenchmark(fixture, options, benchmarkName, "", prepare, params, observations);
+}
 
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.detectGlasses(img, faceBoxAndLandmarks, label, score);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Error: Unable to run glasses detection" << std::endl;
-                return;
-            }
-        }
-    }
+void runGlassesDetection(Fixture &fixture, const SuiteContext &suite,
+                         ObservationList &observations) {
+    benchmarkGlassesDetection(fixture, suite.params(1, 200 * suite.multFactor), observations);
+}
 
-    // Time the glasses detector
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.detectGlasses(img, faceBoxAndLandmarks, label, score);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
+const BenchmarkRegistration registration{benchmarkName, runGlassesDetection};
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, "",
-                              params, times, memoryTracker.getDifferenceFromBaseline());
-}
\ No newline at end of file
+} // namespace
@@ -1,7 +1,7 @@
-#include "memory_high_water_mark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -13,62 +13,47 @@ using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"Head orientation detection (yaw, pitch, roll)"};
 
-void benchmarkHeadOrientation(const SDKFactory &sdkFactory, Parameters params,
-                              ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkHeadOrientation(Fixture &fixture, Parameters params,
+                              ObservationList &observations) {
     // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.initializeModule.faceDetector = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/headshot.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
+    auto prepare = [&fixture, &options](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/headshot.jpg", face)) {
+            return false;
+        }
 
-    FaceBoxAndLandmarks faceBoxAndLandmarks;
-    bool found = false;
-    errorCode = tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
+        Landmarks landmarks;
+        ErrorCode errorCode =
+            tfSdk.getFaceLandmarks(face.image, face.faceBoxAndLandmarks, landmarks);
 
-    if (errorCode != ErrorCode::NO_ERROR || !found) {
-        std::cout << "Unable to detect face in image" << std::endl;
-        return;
-    }
+        if (errorCode != ErrorCode::NO_ERROR) {
+            std::cout << "Unable to detect landmarks" << std::endl;
+            return false;
+        }
 
-    Landmarks landmarks;
-    errorCode = tfSdk.getFaceLandmarks(img, faceBoxAndLandmarks, landmarks);
+        const TFImage img = face.image;
+        const FaceBoxAndLandmarks faceBoxAndLandmarks = face.faceBoxAndLandmarks;
+        HeadOrientation headOrientation;
+        inference = [&tfSdk, img, faceBoxAndLandmarks, landmarks, headOrientation]() mutable {
+            return tfSdk.estimateHeadOrientation(img, faceBoxAndLandmarks, landmarks,
+                                                 headOrientation);
+        };
+        return true;
+    };
 
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Unable to detect landmarks" << std::endl;
-        return;
-    }
+    runBenchmark(fixture, options, benchmarkName, "", prepare, params, observations);
+}
 
-    HeadOrientation headOrientation;
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.estimateHeadOrientation(img, faceBoxAndLandmarks, landmarks, headOrientation);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Unable to run head orientation method" << std::endl;
-                return;
-            }
-        }
-    }
+void runHeadOrientation(Fixture &fixture, const SuiteContext &suite,
+                        ObservationList &observations) {
+    benchmarkHeadOrientation(fixture, suite.params(1, 500 * suite.multFactor), observations);
+}
 
-    // Time the head orientation
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.estimateHeadOrientation(img, faceBoxAndLandmarks, landmarks, headOrientation);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
+const BenchmarkRegistration registration{benchmarkName, runHeadOrientation};
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, "",
-                              params, times, memoryTracker.getDifferenceFromBaseline());
-}
\ No newline at end of file
+} // namespace
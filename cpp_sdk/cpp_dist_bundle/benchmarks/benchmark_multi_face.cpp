@@ -0,0 +1,128 @@
+// Benchmarks the calls made for every face of a frame, on frames of 1 to 16 faces: detectFaces
+// once per frame, then extractAlignedFace and getFaceFeatureVector from the image and face box for
+// every face. The batch size of the per face calls is the number of faces, so their times are per
+// face.
+
+#include "benchmark.h"
+#include "fixture.h"
+#include "observation.h"
+#include "registry.h"
+#include "runner.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Trueface;
+using namespace Trueface::Benchmarks;
+
+const std::string benchmarkName{"Multi-face frame"};
+
+namespace {
+
+const unsigned int faceCounts[] = {1, 2, 4, 8, 16};
+
+// Detects the faces of the frame of numFaces headshots. The cells of the largest frames can get
+// close to the smallest face height, so a frame where some faces are missed only warns.
+bool detectFrameFaces(Fixture &fixture, SDK &tfSdk, unsigned int numFaces, TFImage &img,
+                      std::vector<FaceBoxAndLandmarks> &faceBoxes) {
+    if (!fixture.getMosaic(tfSdk, "../images/headshot.jpg", numFaces, img)) {
+        return false;
+    }
+    if (tfSdk.detectFaces(img, faceBoxes) != ErrorCode::NO_ERROR || faceBoxes.empty()) {
+        std::cout << "Unable to detect faces in the frame of " << numFaces << " faces"
+                  << std::endl;
+        return false;
+    }
+    if (faceBoxes.size() != numFaces) {
+        std::cout << "Warning: " << faceBoxes.size() << " faces detected in the frame of "
+                  << numFaces << " faces" << std::endl;
+    }
+    return true;
+}
+
+void benchmarkMultiFace(Fixture &fixture, unsigned int numFaces, Parameters params,
+                        ObservationList &observations) {
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    options.frModel = FacialRecognitionModel::TFV7;
+    options.initializeModule.faceDetector = true;
+    options.initializeModule.faceRecognizer = true;
+    const std::string faces = std::to_string(numFaces) + (numFaces == 1 ? " face" : " faces");
+
+    auto prepareDetection = [&fixture, numFaces](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        std::vector<FaceBoxAndLandmarks> faceBoxes;
+        if (!detectFrameFaces(fixture, tfSdk, numFaces, img, faceBoxes)) {
+            return false;
+        }
+        inference = [&tfSdk, img, faceBoxes]() mutable {
+            return tfSdk.detectFaces(img, faceBoxes);
+        };
+        return true;
+    };
+    runBenchmark(fixture, options, benchmarkName, "detectFaces, " + faces, prepareDetection,
+                 params, observations);
+
+    // An iteration makes numFaces calls, going around the detected faces if some were missed
+    params.batchSize = numFaces;
+
+    auto prepareAlignment = [&fixture, numFaces](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        std::vector<FaceBoxAndLandmarks> faceBoxes;
+        if (!detectFrameFaces(fixture, tfSdk, numFaces, img, faceBoxes)) {
+            return false;
+        }
+        std::vector<TFFacechip> facechips(faceBoxes.size());
+        inference = [&tfSdk, numFaces, img, faceBoxes, facechips]() mutable {
+            for (unsigned int i = 0; i < numFaces; ++i) {
+                const size_t face = i % faceBoxes.size();
+                auto errorCode = tfSdk.extractAlignedFace(img, faceBoxes[face], facechips[face]);
+                if (errorCode != ErrorCode::NO_ERROR) {
+                    return errorCode;
+                }
+            }
+            return ErrorCode::NO_ERROR;
+        };
+        return true;
+    };
+    runBenchmark(fixture, options, benchmarkName, "extractAlignedFace, " + faces,
+                 prepareAlignment, params, observations);
+
+    auto prepareRecognition = [&fixture, numFaces](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        std::vector<FaceBoxAndLandmarks> faceBoxes;
+        if (!detectFrameFaces(fixture, tfSdk, numFaces, img, faceBoxes)) {
+            return false;
+        }
+        std::vector<Faceprint> faceprints(faceBoxes.size());
+        inference = [&tfSdk, numFaces, img, faceBoxes, faceprints]() mutable {
+            for (unsigned int i = 0; i < numFaces; ++i) {
+                const size_t face = i % faceBoxes.size();
+                auto errorCode = tfSdk.getFaceFeatureVector(img, faceBoxes[face], faceprints[face]);
+                if (errorCode != ErrorCode::NO_ERROR) {
+                    return errorCode;
+                }
+            }
+            return ErrorCode::NO_ERROR;
+        };
+        return true;
+    };
+    runBenchmark(fixture, options, benchmarkName,
+                 "getFaceFeatureVector from image, " + getModelName(options.frModel) + ", " +
+                     faces,
+                 prepareRecognition, params, observations);
+}
+
+void runMultiFace(Fixture &fixture, const SuiteContext &suite, ObservationList &observations) {
+    for (auto numFaces : faceCounts) {
+        benchmarkMultiFace(fixture, numFaces, suite.params(1, 100 * suite.multFactor),
+                           observations);
+    }
+}
+
+const BenchmarkRegistration registration{benchmarkName, runMultiFace};
+
+} // namespace
@@ -1,7 +1,7 @@
-#include "memory_high_water_mark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -13,48 +13,40 @@ using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"Object detection"};
 
-void benchmarkObjectDetection(const SDKFactory &sdkFactory, ObjectDetectionModel objModel,
-                              Parameters params, ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkObjectDetection(Fixture &fixture, ObjectDetectionModel objModel, Parameters params,
+                              ObservationList &observations) {
     // Initialize the SDK with the fast object detection model
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.objModel = objModel;
     options.initializeModule.objectDetector = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/bike.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
-
-    std::vector<BoundingBox> boundingBoxes;
-
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.detectObjects(img, boundingBoxes);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Error: Could not run object detection!" << std::endl;
-                return;
-            }
+    auto prepare = [&fixture](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        if (!fixture.getImage(tfSdk, "../images/bike.jpg", img)) {
+            return false;
         }
-    }
 
-    // Time the object detector
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.detectObjects(img, boundingBoxes);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
+        std::vector<BoundingBox> boundingBoxes;
+        inference = [&tfSdk, img, boundingBoxes]() mutable {
+            return tfSdk.detectObjects(img, boundingBoxes);
+        };
+        return true;
+    };
 
     const std::string mode = (options.objModel == ObjectDetectionModel::FAST) ? "fast" : "accurate";
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, mode,
-                              params, times, memoryTracker.getDifferenceFromBaseline());
-}
\ No newline at end of file
+    runBenchmark(fixture, options, benchmarkName, mode, prepare, params, observations);
+}
+
+void runObjectDetection(Fixture &fixture, const SuiteContext &suite,
+                        ObservationList &observations) {
+    benchmarkObjectDetection(fixture, ObjectDetectionModel::FAST,
+                             suite.params(1, 100 * suite.multFactor), observations);
+    benchmarkObjectDetection(fixture, ObjectDetectionModel::ACCURATE,
+                             suite.params(1, 40 * suite.multFactor), observations);
+}
+
+const BenchmarkRegistration registration{benchmarkName, runObjectDetection};
+
+} // namespace
@@ -0,0 +1,296 @@
+// Benchmarks the full identification pipeline of a video analytics service:
+// preprocessImage -> detectFaces -> extractAlignedFace -> getFaceFeatureVectors ->
+// batchIdentifyTopCandidate, against a populated in-memory collection.
+// Every stage is timed within the same frames, so the stage observations add up to the total.
+
+#include "file_io.h"
+#include "fixture.h"
+#include "observation.h"
+#include "registry.h"
+#include "runner.h"
+#include "stopwatch.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Trueface;
+using namespace Trueface::Benchmarks;
+
+namespace {
+
+const std::string benchmarkName{"End-to-end pipeline"};
+
+enum Stage { PREPROCESS, DETECT, ALIGN, EXTRACT, IDENTIFY, NUM_STAGES };
+
+const char *stageNames[NUM_STAGES] = {"preprocessImage", "detectFaces", "extractAlignedFace",
+                                      "getFaceFeatureVectors", "batchIdentifyTopCandidate"};
+
+// Frames with one or several faces, as the encoded JPGs a camera or a client would send
+const std::vector<std::string> framePaths = {
+    "../../images/person_on_bike.jpg", "../../images/brad_pitt_1.jpg",
+    "../../images/far_shot_real_person.jpg", "../../images/tom_cruise_2.jpg",
+    "../images/headshot.jpg"};
+
+// Templates replicated to populate the collection
+const std::vector<std::string> enrollmentPaths = {
+    "../../images/tom_cruise_1.jpg", "../../images/tom_cruise_3.jpg",
+    "../../images/brad_pitt_2.jpg", "../images/headshot.jpg"};
+
+const size_t collectionSize = 10000;
+
+bool populateCollection(SDK &tfSdk) {
+    std::vector<Faceprint> faceprints;
+    for (const auto &path : enrollmentPaths) {
+        TFImage img;
+        Faceprint faceprint;
+        bool found = false;
+        if (tfSdk.preprocessImage(path, img) != ErrorCode::NO_ERROR ||
+            tfSdk.getLargestFaceFeatureVector(img, faceprint, found) != ErrorCode::NO_ERROR ||
+            !found) {
+            std::cout << "Error: unable to extract the template of " << path << std::endl;
+            return false;
+        }
+        faceprints.push_back(faceprint);
+    }
+
+    // We are using the DatabaseManagementSystem::NONE so the collection will not persist
+    if (tfSdk.createLoadCollection("pipeline_collection") != ErrorCode::NO_ERROR) {
+        std::cout << "Error creating collection" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < collectionSize; ++i) {
+        std::string UUID;
+        if (tfSdk.enrollFaceprint(faceprints[i % faceprints.size()],
+                                  "identity " + std::to_string(i), UUID) != ErrorCode::NO_ERROR) {
+            std::cout << "Unable to enroll template" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Holds the outputs of every stage, so the buffers are reused from one iteration to the next
+struct PipelineState {
+    std::vector<TFImage> images;
+    std::vector<std::vector<FaceBoxAndLandmarks>> faces;
+    std::vector<TFFacechip> facechips;
+    std::vector<Faceprint> faceprints;
+    std::vector<Candidate> candidates;
+    std::vector<bool> found;
+    // The frames cycled through
+    size_t nextFrame = 0;
+};
+
+// Runs batchSize frames through the pipeline and returns the time spent in every stage in
+// stageTimes. The faces of all the frames are recognized and identified in single batched calls.
+ErrorCode runPipeline(SDK &tfSdk, const std::vector<std::vector<uint8_t>> &frames,
+                      unsigned int batchSize, PipelineState &state, float stageTimes[NUM_STAGES]) {
+    state.images.resize(batchSize);
+    state.faces.resize(batchSize);
+
+    preciseStopwatch stopwatch;
+    for (size_t i = 0; i < batchSize; ++i) {
+        const auto &frame = frames[state.nextFrame++ % frames.size()];
+        auto errorCode = tfSdk.preprocessImage(frame, state.images[i]);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            return errorCode;
+        }
+    }
+    stageTimes[PREPROCESS] = stopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+
+    stopwatch = preciseStopwatch();
+    for (size_t i = 0; i < batchSize; ++i) {
+        auto errorCode = tfSdk.detectFaces(state.images[i], state.faces[i]);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            return errorCode;
+        }
+    }
+    stageTimes[DETECT] = stopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+
+    stopwatch = preciseStopwatch();
+    state.facechips.clear();
+    for (size_t i = 0; i < batchSize; ++i) {
+        for (const auto &face : state.faces[i]) {
+            TFFacechip facechip;
+            auto errorCode = tfSdk.extractAlignedFace(state.images[i], face, facechip);
+            if (errorCode != ErrorCode::NO_ERROR) {
+                return errorCode;
+            }
+            state.facechips.push_back(facechip);
+        }
+    }
+    stageTimes[ALIGN] = stopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+
+    stopwatch = preciseStopwatch();
+    if (!state.facechips.empty()) {
+        auto errorCode = tfSdk.getFaceFeatureVectors(state.facechips, state.faceprints);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            return errorCode;
+        }
+    }
+    stageTimes[EXTRACT] = stopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+
+    stopwatch = preciseStopwatch();
+    if (!state.facechips.empty()) {
+        auto errorCode =
+            tfSdk.batchIdentifyTopCandidate(state.faceprints, state.candidates, state.found);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            return errorCode;
+        }
+    }
+    stageTimes[IDENTIFY] = stopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+    return ErrorCode::NO_ERROR;
+}
+
+// Time spent in every stage by each call of the pipeline, up to maxCalls calls. The times are
+// reserved up front, as growing them would allocate within the timed iterations.
+struct StageTimes {
+    explicit StageTimes(size_t maxCalls) : maxCalls{maxCalls} {
+        for (auto &stage : times) {
+            stage.reserve(maxCalls);
+        }
+    }
+
+    void record(const float stageTimes[NUM_STAGES]) {
+        if (times[0].size() >= maxCalls) {
+            return;
+        }
+        for (size_t stage = 0; stage < NUM_STAGES; ++stage) {
+            times[stage].push_back(stageTimes[stage]);
+        }
+    }
+
+    const size_t maxCalls;
+    std::vector<float> times[NUM_STAGES];
+};
+
+void benchmarkPipeline(const SDKFactory &sdkFactory, Parameters params,
+                       ObservationList &observations) {
+    // The model loads are measured by the benchmarks of the individual stages
+    if (params.coldStart.enabled) {
+        return;
+    }
+
+    // Not taken from the fixture, the SDK holds the collection the pipeline populates
+    auto options = sdkFactory.createBasicConfiguration();
+    options.frModel = FacialRecognitionModel::TFV7;
+    options.dbms = DatabaseManagementSystem::NONE;
+    options.initializeModule.faceDetector = true;
+    options.initializeModule.faceRecognizer = true;
+
+    // shared by the inferences of every thread
+    auto frames = std::make_shared<std::vector<std::vector<uint8_t>>>(framePaths.size());
+    for (size_t i = 0; i < framePaths.size(); ++i) {
+        if (!readFile(framePaths[i], (*frames)[i])) {
+            std::cout << "Error: could not load the image " << framePaths[i] << std::endl;
+            return;
+        }
+    }
+
+    // The batch size is the number of frames per iteration
+    const std::string numFrames = std::to_string(params.batchSize) +
+                                  (params.batchSize == 1 ? " frame" : " frames");
+
+    // Warm up on every frame at least once, so all the input sizes have been seen
+    params.numWarmup = std::max<int>(params.numWarmup, static_cast<int>(frames->size()));
+
+    // Only the first inference, which runs the single threaded iterations, records its stages. The
+    // adaptive warmup has no maximum count, one longer than half the maximum number of timed
+    // iterations leaves no room for them.
+    const auto &adaptive = params.adaptive;
+    auto stageTimes = std::make_shared<StageTimes>(
+        params.numWarmup + (adaptive.enabled ? adaptive.maxIterations + adaptive.maxIterations / 2
+                                             : params.numIterations));
+    bool isFirstInference = true;
+    std::set<const SDK *> populatedSdks;
+    const unsigned int batchSize = params.batchSize;
+    const InferenceFactory prepare = [&](SDK &tfSdk, Inference &inference) {
+        // the throughput mode prepares several inferences on the same SDK
+        if (!populatedSdks.count(&tfSdk)) {
+            if (!populateCollection(tfSdk)) {
+                return false;
+            }
+            populatedSdks.insert(&tfSdk);
+        }
+
+        auto state = std::make_shared<PipelineState>();
+        auto recordedTimes = isFirstInference ? stageTimes : nullptr;
+        isFirstInference = false;
+        inference = [&tfSdk, frames, state, recordedTimes, batchSize]() {
+            float times[NUM_STAGES];
+            auto errorCode = runPipeline(tfSdk, *frames, batchSize, *state, times);
+            if (recordedTimes) {
+                recordedTimes->record(times);
+            }
+            return errorCode;
+        };
+        return true;
+    };
+
+    const size_t firstObservation = observations.size();
+    runBenchmark(sdkFactory, options, benchmarkName, "total, " + numFrames, prepare, params,
+                 observations);
+    if (observations.size() == firstObservation) {
+        return;
+    }
+
+    // The stages of the timed single threaded iterations, which follow the warmup. Copied as
+    // adding the stage observations may move the total.
+    const auto &total = observations[firstObservation];
+    const auto runParams = total.getParameters();
+    const auto stopReason = total.getStopReason();
+    const float frameMean = total.getTimeResult().mean;
+    const std::string version = total.getVersion();
+    const size_t first = runParams.doWarmup ? runParams.numWarmup : 0;
+    const size_t last = first + runParams.numIterations;
+    if (stageTimes->times[0].size() < last) {
+        std::cout << "The stages of the pipeline are not reported, only "
+                  << stageTimes->times[0].size() << " of its " << last
+                  << " warmup and timed iterations were recorded" << std::endl;
+        return;
+    }
+    float stageTotals[NUM_STAGES] = {};
+    float pipelineTotal = 0.f;
+    for (size_t stage = 0; stage < NUM_STAGES; ++stage) {
+        const auto &recorded = stageTimes->times[stage];
+        const std::vector<float> times(recorded.begin() + first, recorded.begin() + last);
+        stageTotals[stage] = std::accumulate(times.begin(), times.end(), 0.f);
+        pipelineTotal += stageTotals[stage];
+        observations.emplace_back(version, sdkFactory.isGpuEnabled(), benchmarkName,
+                                  std::string(stageNames[stage]) + ", " + numFrames, runParams,
+                                  times, MemoryProfile{}, stopReason);
+    }
+
+    // Where the time of a frame goes
+    if (pipelineTotal > 0.f && frameMean > 0.f) {
+        for (size_t stage = 0; stage < NUM_STAGES; ++stage) {
+            std::cout << "  " << stageNames[stage] << ": "
+                      << 100.f * stageTotals[stage] / pipelineTotal << "% of the pipeline"
+                      << std::endl;
+        }
+        std::cout << "  " << 1000.f / frameMean << " frames/s" << std::endl;
+    }
+}
+
+// The whole pipeline, one frame at a time and with the faces of several frames batched
+void runEndToEndPipeline(Fixture &fixture, const SuiteContext &suite,
+                         ObservationList &observations) {
+    for (auto numFrames : {1u, 8u}) {
+        benchmarkPipeline(fixture.getSDKFactory(),
+                          suite.params(numFrames, 200 * suite.multFactor / numFrames),
+                          observations);
+    }
+}
+
+const BenchmarkRegistration registration{benchmarkName, runEndToEndPipeline};
+
+} // namespace
@@ -1,116 +1,242 @@
-#include "memory_high_water_mark.h"
+#include "file_io.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
 
-#include <fstream>
+#include <cstdio>
 #include <iostream>
+#include <string>
+#include <vector>
 
 using namespace Trueface;
 using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"Preprocess image"};
 
-void benchmarkPreprocessImage(const SDKFactory &sdkFactory, Parameters params,
-                              ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
+
+struct Resolution {
+    const char *name;
+    int width;
+    int height;
+};
+
+const Resolution resolutions[] = {{"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4K", 3840, 2160}};
+
+// Smooth gradients with some texture, which compress like camera frames rather than like noise
+std::vector<uint8_t> createSyntheticFrame(int width, int height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint8_t *pixel = &pixels[(static_cast<size_t>(y) * width + x) * 3];
+            pixel[0] = static_cast<uint8_t>(255 * x / width);
+            pixel[1] = static_cast<uint8_t>(255 * y / height);
+            pixel[2] = static_cast<uint8_t>(((x / 16 + y / 16) % 2) * 64 + (x * y) % 32);
+        }
+    }
+    return pixels;
+}
+
+// Scales a decoded RGB image to the resolution with nearest neighbour sampling
+std::vector<uint8_t> scaleFrame(const TFImage &img, int width, int height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 3);
+    const uint8_t *source = img->getData();
+    const int sourceWidth = img->getWidth();
+    const int sourceHeight = img->getHeight();
+    for (int y = 0; y < height; ++y) {
+        const int sourceY = y * sourceHeight / height;
+        for (int x = 0; x < width; ++x) {
+            const int sourceX = x * sourceWidth / width;
+            const uint8_t *sourcePixel =
+                &source[(static_cast<size_t>(sourceY) * sourceWidth + sourceX) * 3];
+            std::copy(sourcePixel, sourcePixel + 3,
+                      &pixels[(static_cast<size_t>(y) * width + x) * 3]);
+        }
+    }
+    return pixels;
+}
 
-    // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
-    auto tfSdk = sdkFactory.createSDK(options);
-    const std::string imgPath = "../images/headshot.jpg";
+std::vector<uint8_t> swapRedBlue(std::vector<uint8_t> pixels) {
+    for (size_t i = 0; i + 2 < pixels.size(); i += 3) {
+        std::swap(pixels[i], pixels[i + 2]);
+    }
+    return pixels;
+}
+
+// Copies the rows into a buffer whose rows are padded to a multiple of 4096 bytes, as in a frame
+// cropped from a wider buffer or allocated with a pitch on the GPU
+std::vector<uint8_t> padRows(const std::vector<uint8_t> &pixels, int width, int height,
+                             int &step) {
+    const int rowSize = width * 3;
+    step = (rowSize + 4095) / 4096 * 4096;
+    std::vector<uint8_t> padded(static_cast<size_t>(step) * height);
+    for (int y = 0; y < height; ++y) {
+        std::copy(pixels.begin() + static_cast<size_t>(y) * rowSize,
+                  pixels.begin() + static_cast<size_t>(y + 1) * rowSize,
+                  padded.begin() + static_cast<size_t>(y) * step);
+    }
+    return padded;
+}
 
-    // First run the benchmark for an image on disk
-    // Run once to ensure everything works
+// Encodes the pixels by saving them with the extension of path, and reads back the encoded bytes
+bool encodeFrame(SDK &tfSdk, std::vector<uint8_t> pixels, int width, int height,
+                 const std::string &path, std::vector<uint8_t> &encoded) {
     TFImage img;
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            auto errorcode = tfSdk.preprocessImage(imgPath, img);
-            if (errorcode != ErrorCode::NO_ERROR) {
-                std::cout << "Unable to preprocess the image" << std::endl;
-                return;
-            }
-        }
+    if (tfSdk.preprocessImage(pixels.data(), width, height, ColorCode::rgb, img) !=
+        ErrorCode::NO_ERROR) {
+        return false;
     }
+    img->saveImage(path);
+
+    const bool isRead = readFile(path, encoded);
+    std::remove(path.c_str());
+    return isRead;
+}
+
+void benchmarkPixelsArray(Fixture &fixture, const ConfigurationOptions &options,
+                          const std::string &subType, const std::vector<uint8_t> &pixels,
+                          int width, int height, ColorCode colorCode, int step, Parameters params,
+                          ObservationList &observations) {
+    // The data rate counts the pixels, not the padding
+    params.inputSize = InputSize{width * height * 3 / 1e6f, width * height / 1e6f};
+    auto prepare = [&pixels, width, height, colorCode, step](SDK &tfSdk, Inference &inference) {
+        std::vector<uint8_t> frame = pixels;
+        TFImage img;
+        inference = [&tfSdk, frame, width, height, colorCode, step, img]() mutable {
+            return tfSdk.preprocessImage(frame.data(), width, height, colorCode, img, step);
+        };
+        return true;
+    };
+    runBenchmark(fixture, options, benchmarkName, subType, prepare, params, observations);
+}
+
+void benchmarkEncoded(Fixture &fixture, const ConfigurationOptions &options,
+                      const std::string &subType, const std::vector<uint8_t> &encoded, int width,
+                      int height, Parameters params, ObservationList &observations) {
+    // The data rate of the encoded images counts the compressed bytes
+    params.inputSize = InputSize{encoded.size() / 1e6f, width * height / 1e6f};
+    auto prepare = [&encoded](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        inference = [&tfSdk, encoded, img]() mutable {
+            return tfSdk.preprocessImage(encoded, img);
+        };
+        return true;
+    };
+    runBenchmark(fixture, options, benchmarkName, subType, prepare, params, observations);
+}
+
+void benchmarkPreprocessImage(Fixture &fixture, Parameters params,
+                              ObservationList &observations) {
+    // Initialize the SDK
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    const std::string imgPath = "../images/headshot.jpg";
 
-    // Time the preprocessImage function
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.preprocessImage(imgPath, img);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+    // The headshot sizes, for the data and pixel rates
+    std::vector<uint8_t> encodedImg;
+    TFImage realImg;
+    auto &imgSdk = fixture.getSDK(options);
+    if (!readFile(imgPath, encodedImg) || !fixture.getImage(imgSdk, imgPath, realImg)) {
+        std::cout << "Unable to load the image" << std::endl;
+        return;
     }
+    const float megapixels = realImg->getWidth() * realImg->getHeight() / 1e6f;
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
-                              "JPG from disk", params, times,
-                              memoryTracker.getDifferenceFromBaseline());
-
-    // baseline memory reading
-    memoryTracker.resetVmHighWaterMark();
+    // First run the benchmark for an image on disk
+    auto prepareFromDisk = [&imgPath](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        inference = [&tfSdk, imgPath, img]() mutable {
+            return tfSdk.preprocessImage(imgPath, img);
+        };
+        return true;
+    };
+
+    Parameters encodedParams = params;
+    encodedParams.inputSize = InputSize{encodedImg.size() / 1e6f, megapixels};
+    runBenchmark(fixture, options, benchmarkName, "JPG from disk", prepareFromDisk,
+                 encodedParams, observations);
 
     // Now repeat with encoded image in memory
-    std::ifstream file(imgPath, std::ios::binary | std::ios::ate);
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
+    auto prepareEncoded = [&encodedImg](SDK &tfSdk, Inference &inference) {
+        std::vector<uint8_t> buffer = encodedImg;
+        TFImage img;
+        inference = [&tfSdk, buffer, img]() mutable { return tfSdk.preprocessImage(buffer, img); };
+        return true;
+    };
 
-    std::vector<uint8_t> buffer(size);
-    if (!file.read(reinterpret_cast<char *>(buffer.data()), size)) {
-        std::cout << "Unable to load the image" << std::endl;
-        return;
-    }
+    runBenchmark(fixture, options, benchmarkName, "encoded JPG in memory", prepareEncoded,
+                 encodedParams, observations);
 
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            auto errorcode = tfSdk.preprocessImage(buffer, img);
-            if (errorcode != ErrorCode::NO_ERROR) {
-                std::cout << "Unable to preprocess the image" << std::endl;
-                return;
-            }
+    // Now repeat with already decoded imgages (ex. you grab an image from your video stream).
+    auto prepareDecoded = [&fixture, &imgPath](SDK &tfSdk, Inference &inference) {
+        TFImage img;
+        if (!fixture.getImage(tfSdk, imgPath, img)) {
+            return false;
         }
-    }
 
-    // Time the preprocessImage function
-    times.clear();
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.preprocessImage(buffer, img);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+        TFImage newImg;
+        inference = [&tfSdk, img, newImg]() mutable {
+            return tfSdk.preprocessImage(img->getData(), img->getWidth(), img->getHeight(),
+                                         ColorCode::rgb, newImg);
+        };
+        return true;
+    };
+
+    Parameters decodedParams = params;
+    decodedParams.inputSize = InputSize{3 * megapixels, megapixels};
+    runBenchmark(fixture, options, benchmarkName, "RGB pixels array in memory", prepareDecoded,
+                 decodedParams, observations);
+
+    // Repeat with synthetic and real frames at camera resolutions, in the layouts and encodings
+    // a video pipeline hands over. They load no model, so there is no cold start to measure.
+    if (params.coldStart.enabled) {
+        return;
     }
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
-                              "encoded JPG in memory", params, times,
-                              memoryTracker.getDifferenceFromBaseline());
-
-    // Baseline memory reading
-    memoryTracker.resetVmHighWaterMark();
-
-    // Now repeat with already decoded imgages (ex. you grab an image from your video stream).
-    TFImage newImg;
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            auto errorCode = tfSdk.preprocessImage(img->getData(), img->getWidth(),
-                                                   img->getHeight(), ColorCode::rgb, newImg);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Error: Unable to preprocess image" << std::endl;
-                return;
+    for (const auto &resolution : resolutions) {
+        const int width = resolution.width;
+        const int height = resolution.height;
+        for (const bool isReal : {false, true}) {
+            const std::string frameName =
+                std::string(resolution.name) + (isReal ? " real frame, " : " synthetic frame, ");
+            const auto rgb = isReal ? scaleFrame(realImg, width, height)
+                                    : createSyntheticFrame(width, height);
+            int step = 0;
+            const auto padded = padRows(rgb, width, height, step);
+            const auto bgr = swapRedBlue(rgb);
+
+            benchmarkPixelsArray(fixture, options, frameName + "RGB pixels array", rgb, width,
+                                 height, ColorCode::rgb, 0, params, observations);
+            benchmarkPixelsArray(fixture, options, frameName + "BGR pixels array", bgr, width,
+                                 height, ColorCode::bgr, 0, params, observations);
+            benchmarkPixelsArray(fixture, options,
+                                 frameName + "RGB pixels array with padded rows", padded, width,
+                                 height, ColorCode::rgb, step, params, observations);
+
+            for (const std::string extension : {"jpg", "png"}) {
+                std::vector<uint8_t> encoded;
+                if (!encodeFrame(imgSdk, rgb, width, height, "preprocess_frame." + extension,
+                                 encoded)) {
+                    std::cout << "Unable to encode the frame as " << extension << std::endl;
+                    continue;
+                }
+                std::string encoding = extension == "jpg" ? "JPG" : "PNG";
+                benchmarkEncoded(fixture, options,
+                                 frameName + "encoded " + encoding + " in memory", encoded, width,
+                                 height, params, observations);
             }
         }
     }
+}
 
-    times.clear();
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.preprocessImage(img->getData(), img->getWidth(), img->getHeight(), ColorCode::rgb,
-                              newImg);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
+void runPreprocessImage(Fixture &fixture, const SuiteContext &suite,
+                        ObservationList &observations) {
+    benchmarkPreprocessImage(fixture, suite.params(1, 200), observations);
+}
+
+const BenchmarkRegistration registration{benchmarkName, runPreprocessImage};
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
-                              "RGB pixels array in memory", params, times,
-                              memoryTracker.getDifferenceFromBaseline());
-}
\ No newline at end of file
+} // namespace
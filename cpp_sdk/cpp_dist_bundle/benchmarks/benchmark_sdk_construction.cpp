@@ -0,0 +1,37 @@
+#include "cold_start.h"
+#include "fixture.h"
+#include "observation.h"
+#include "registry.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+using namespace Trueface;
+using namespace Trueface::Benchmarks;
+
+const std::string benchmarkName{"SDK construction"};
+
+namespace {
+
+void benchmarkSDKConstruction(const SDKFactory &sdkFactory, Parameters params,
+                              ObservationList &observations) {
+    // No module is initialized, this is the baseline of the eager loads
+    auto options = sdkFactory.createBasicConfiguration();
+    options.useGlobalInferenceThreadpool = params.inferenceThreading.useGlobalThreadpool;
+
+    runColdStart(sdkFactory, options, benchmarkName, "", InferenceFactory{}, params,
+                 observations);
+}
+
+// Only measured with --cold-start, the steady state has nothing to time
+void runSDKConstruction(Fixture &fixture, const SuiteContext &suite,
+                        ObservationList &observations) {
+    const auto params = suite.params(1, 0);
+    if (params.coldStart.enabled) {
+        benchmarkSDKConstruction(fixture.getSDKFactory(), params, observations);
+    }
+}
+
+const BenchmarkRegistration registration{benchmarkName, runSDKConstruction};
+
+} // namespace
@@ -0,0 +1,224 @@
+#include "benchmark.h"
+#include "fixture.h"
+#include "observation.h"
+#include "registry.h"
+#include "runner.h"
+#include "similarity_kernel.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Trueface;
+using namespace Trueface::Benchmarks;
+
+namespace {
+
+const std::string benchmarkName{"1 to 1 similarity"};
+
+// Comparisons per timed iteration, a single one is too short to time
+const unsigned int numCallsPerIteration = 1000;
+// Pairs of the bulk comparison, enough for the vectors not to fit in the last level cache
+const size_t numBulkPairs = 16384;
+
+// Largest difference from the similarity of the scalar kernel, from the order of the sums
+const float kernelTolerance = 1e-4f;
+
+// The similarities are stored here, so that the compiler cannot drop the kernels as unused
+volatile float similaritySink;
+
+// Random vectors of the bulk comparison, shared by the inferences of every thread
+struct BulkPairs {
+    std::vector<float> a;
+    std::vector<float> b;
+};
+
+bool getFaceprints(Fixture &fixture, SDK &tfSdk, const ConfigurationOptions &options,
+                   Faceprint &faceprint1, Faceprint &faceprint2) {
+    const std::vector<std::pair<std::string, Faceprint *>> images{
+        {"../images/headshot.jpg", &faceprint1}, {"../../images/brad_pitt_1.jpg", &faceprint2}};
+    for (const auto &image : images) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, image.first, face)) {
+            return false;
+        }
+        if (tfSdk.getFaceFeatureVector(face.facechip, *image.second) != ErrorCode::NO_ERROR) {
+            std::cout << "Error: unable to extract the template of " << image.first << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// The SIMD levels supported by the CPU whose kernel agrees with the scalar kernel on the templates
+// of two faces. The others are reported and left out. Nothing is checked for the cold start, which
+// only times the model load.
+std::vector<SimdLevel> getMatchingSimdLevels(Fixture &fixture, ConfigurationOptions options,
+                                             const Parameters &params,
+                                             const std::string &modelName) {
+    std::vector<SimdLevel> levels;
+    const auto supportedLevel = getSupportedSimdLevel();
+    if (params.coldStart.enabled) {
+        for (auto level : {SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            if (level <= supportedLevel) {
+                levels.push_back(level);
+            }
+        }
+        return levels;
+    }
+
+    // the instance the benchmarks use
+    options.useGlobalInferenceThreadpool = params.inferenceThreading.useGlobalThreadpool;
+    Faceprint faceprint1;
+    Faceprint faceprint2;
+    if (!getFaceprints(fixture, fixture.getSDK(options), options, faceprint1, faceprint2)) {
+        return levels;
+    }
+    const auto &a = faceprint1.featureVector;
+    const auto &b = faceprint2.featureVector;
+    const float expected = cosineSimilarity(a.data(), b.data(), a.size(), SimdLevel::SCALAR);
+
+    for (auto level : {SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level > supportedLevel) {
+            break;
+        }
+        const float similarity = cosineSimilarity(a.data(), b.data(), a.size(), level);
+        if (std::abs(similarity - expected) > kernelTolerance) {
+            std::cout << "Error: the " << toString(level) << " cosine kernel returns " << similarity
+                      << " instead of " << expected << " for " << modelName
+                      << ", it is not benchmarked" << std::endl;
+            continue;
+        }
+        levels.push_back(level);
+    }
+    return levels;
+}
+
+void benchmarkSimilarity(Fixture &fixture, FacialRecognitionModel model, Parameters params,
+                         ObservationList &observations) {
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
+    options.frModel = model;
+    options.initializeModule.faceRecognizer = true;
+    params.batchSize = numCallsPerIteration;
+
+    for (bool frVectorCompression : {false, true}) {
+        options.frVectorCompression = frVectorCompression;
+        const std::string modelName =
+            getModelName(model) + (frVectorCompression ? " compressed" : "");
+
+        auto prepareSdk = [&fixture, &options](SDK &tfSdk, Inference &inference) {
+            Faceprint faceprint1;
+            Faceprint faceprint2;
+            if (!getFaceprints(fixture, tfSdk, options, faceprint1, faceprint2)) {
+                return false;
+            }
+            inference = [faceprint1, faceprint2]() {
+                float matchProbability = 0.f;
+                float similarityMeasure = 0.f;
+                for (unsigned int i = 0; i < numCallsPerIteration; ++i) {
+                    auto errorCode = SDK::getSimilarity(faceprint1, faceprint2, matchProbability,
+                                                        similarityMeasure);
+                    if (errorCode != ErrorCode::NO_ERROR) {
+                        return errorCode;
+                    }
+                }
+                return ErrorCode::NO_ERROR;
+            };
+            return true;
+        };
+        runBenchmark(fixture, options, benchmarkName, modelName + ", getSimilarity",
+                     prepareSdk, params, observations);
+
+        // The kernels work on the raw floats, which only the uncompressed templates are
+        if (frVectorCompression) {
+            continue;
+        }
+
+        for (auto level : getMatchingSimdLevels(fixture, options, params, modelName)) {
+            auto prepareKernel = [&fixture, &options, level](SDK &tfSdk, Inference &inference) {
+                Faceprint faceprint1;
+                Faceprint faceprint2;
+                if (!getFaceprints(fixture, tfSdk, options, faceprint1, faceprint2)) {
+                    return false;
+                }
+
+                const auto &a = faceprint1.featureVector;
+                const auto &b = faceprint2.featureVector;
+                inference = [level, a, b]() {
+                    float total = 0.f;
+                    for (unsigned int i = 0; i < numCallsPerIteration; ++i) {
+                        total += cosineSimilarity(a.data(), b.data(), a.size(), level);
+                    }
+                    similaritySink = total;
+                    return ErrorCode::NO_ERROR;
+                };
+                return true;
+            };
+            runBenchmark(fixture, options, benchmarkName,
+                         modelName + ", cosine kernel " + toString(level), prepareKernel, params,
+                         observations);
+
+            // Distinct pairs streamed from memory, as when re-verifying millions of pairs. The
+            // vectors are generated once and shared, as copying them with every inference would
+            // add 128 MB per copy to the memory profile.
+            std::shared_ptr<const BulkPairs> pairs;
+            auto prepareBulk = [&fixture, &options, &pairs, level](SDK &tfSdk,
+                                                                   Inference &inference) {
+                Faceprint faceprint1;
+                Faceprint faceprint2;
+                if (!getFaceprints(fixture, tfSdk, options, faceprint1, faceprint2)) {
+                    return false;
+                }
+                const size_t size = faceprint1.featureVector.size();
+                if (!pairs) {
+                    auto generated = std::make_shared<BulkPairs>();
+                    generated->a.resize(numBulkPairs * size);
+                    generated->b.resize(numBulkPairs * size);
+                    std::mt19937 engine{1};
+                    std::normal_distribution<float> distribution;
+                    for (size_t i = 0; i < generated->a.size(); ++i) {
+                        generated->a[i] = distribution(engine);
+                        generated->b[i] = distribution(engine);
+                    }
+                    pairs = generated;
+                }
+
+                // every thread writes its own similarities
+                auto similarities = std::make_shared<std::vector<float>>(numBulkPairs);
+                const auto bulkPairs = pairs;
+                inference = [level, size, bulkPairs, similarities]() {
+                    cosineSimilarities(bulkPairs->a.data(), bulkPairs->b.data(), numBulkPairs,
+                                       size, similarities->data(), level);
+                    similaritySink = similarities->back();
+                    return ErrorCode::NO_ERROR;
+                };
+                return true;
+            };
+            auto bulkParams = params;
+            bulkParams.batchSize = numBulkPairs;
+            runBenchmark(fixture, options, benchmarkName,
+                         modelName + ", bulk cosine kernel " + toString(level) + " (" +
+                             std::to_string(numBulkPairs) + " pairs)",
+                         prepareBulk, bulkParams, observations);
+        }
+    }
+}
+
+void runSimilarity(Fixture &fixture, const SuiteContext &suite, ObservationList &observations) {
+    for (auto model : {FacialRecognitionModel::LITE_V2, FacialRecognitionModel::LITE_V3,
+                       FacialRecognitionModel::TFV5_2, FacialRecognitionModel::TFV6,
+                       FacialRecognitionModel::TFV7}) {
+        benchmarkSimilarity(fixture, model, suite.params(1, 100), observations);
+    }
+}
+
+const BenchmarkRegistration registration{benchmarkName, runSimilarity};
+
+} // namespace
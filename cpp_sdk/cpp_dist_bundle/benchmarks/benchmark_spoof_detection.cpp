@@ -1,7 +1,7 @@
-#include "memory_high_water_mark.h"
+#include "fixture.h"
 #include "observation.h"
-#include "sdkfactory.h"
-#include "stopwatch.h"
+#include "registry.h"
+#include "runner.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -13,58 +13,38 @@ using namespace Trueface::Benchmarks;
 
 const std::string benchmarkName{"Passive spoof detection"};
 
-void benchmarkSpoofDetection(const SDKFactory &sdkFactory, Parameters params,
-                             ObservationList &observations) {
-    // Baseline memory reading
-    auto memoryTracker = MemoryHighWaterMarkTracker();
+namespace {
 
+void benchmarkSpoofDetection(Fixture &fixture, Parameters params, ObservationList &observations) {
     // Initialize the SDK
-    auto options = sdkFactory.createBasicConfiguration();
+    auto options = fixture.getSDKFactory().createBasicConfiguration();
     options.initializeModule.faceDetector = true;
     options.initializeModule.passiveSpoof = true;
 
-    auto tfSdk = sdkFactory.createSDK(options);
-
-    // Load the image
-    TFImage img;
-    ErrorCode errorCode = tfSdk.preprocessImage("../images/real_spoof.jpg", img);
-    if (errorCode != ErrorCode::NO_ERROR) {
-        std::cout << "Error: could not load the image" << std::endl;
-        return;
-    }
-
-    FaceBoxAndLandmarks faceBoxAndLandmarks;
-    bool found = false;
-    errorCode = tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
+    auto prepare = [&fixture, &options](SDK &tfSdk, Inference &inference) {
+        FaceInput face;
+        if (!fixture.getLargestFace(tfSdk, options, "../images/real_spoof.jpg", face)) {
+            return false;
+        }
 
-    if (errorCode != ErrorCode::NO_ERROR || !found) {
-        std::cout << "Unable to detect face in image" << std::endl;
-        return;
-    }
+        const TFImage img = face.image;
+        const FaceBoxAndLandmarks faceBoxAndLandmarks = face.faceBoxAndLandmarks;
+        float spoofScore{};
+        SpoofLabel label{};
+        inference = [&tfSdk, img, faceBoxAndLandmarks, label, spoofScore]() mutable {
+            return tfSdk.detectSpoof(img, faceBoxAndLandmarks, label, spoofScore);
+        };
+        return true;
+    };
 
-    float spoofScore;
-    SpoofLabel label;
+    runBenchmark(fixture, options, benchmarkName, "", prepare, params, observations);
+}
 
-    if (params.doWarmup) {
-        for (int i = 0; i < params.numWarmup; ++i) {
-            errorCode = tfSdk.detectSpoof(img, faceBoxAndLandmarks, label, spoofScore);
-            if (errorCode != ErrorCode::NO_ERROR) {
-                std::cout << "Spoof function failed" << std::endl;
-                std::cout << errorCode << std::endl;
-                return;
-            }
-        }
-    }
+void runSpoofDetection(Fixture &fixture, const SuiteContext &suite,
+                       ObservationList &observations) {
+    benchmarkSpoofDetection(fixture, suite.params(1, 100 * suite.multFactor), observations);
+}
 
-    // Time the spoof detector
-    std::vector<float> times;
-    times.reserve(params.numIterations);
-    for (size_t i = 0; i < params.numIterations; ++i) {
-        preciseStopwatch stopwatch;
-        tfSdk.detectSpoof(img, faceBoxAndLandmarks, label, spoofScore);
-        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
-    }
+const BenchmarkRegistration registration{benchmarkName, runSpoofDetection};
 
-    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName, "",
-                              params, times, memoryTracker.getDifferenceFromBaseline());
-}
\ No newline at end of file
+} // namespace
@@ -0,0 +1,105 @@
+#include "child_process.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Trueface {
+namespace Benchmarks {
+
+#if !defined(WIN32) && !defined(_WIN32) && !defined(__APPLE__)
+namespace {
+bool evictFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool evicted = !::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+    return evicted;
+}
+} // namespace
+
+bool dropPageCache(const std::string &path) {
+    ::sync();
+    {
+        std::ofstream dropCaches{"/proc/sys/vm/drop_caches"};
+        if (dropCaches << "1" << std::flush) {
+            return true;
+        }
+    }
+
+    struct stat info {};
+    if (path.empty() || ::stat(path.c_str(), &info)) {
+        return false;
+    }
+    if (S_ISREG(info.st_mode)) {
+        return evictFile(path);
+    }
+
+    DIR *dir = ::opendir(path.c_str());
+    if (!dir) {
+        return false;
+    }
+
+    bool evicted = false;
+    while (auto entry = ::readdir(dir)) {
+        const auto filePath = path + "/" + entry->d_name;
+        if (::stat(filePath.c_str(), &info) || !S_ISREG(info.st_mode)) {
+            continue;
+        }
+        evicted |= evictFile(filePath);
+    }
+    ::closedir(dir);
+
+    return evicted;
+}
+#else
+bool dropPageCache(const std::string &) { return false; }
+#endif
+
+#if !defined(WIN32) && !defined(_WIN32)
+bool runSelfInChild(const std::string &program, const std::vector<std::string> &args,
+                    const std::map<std::string, std::string> &environment) {
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        return false;
+    }
+
+    if (pid == 0) {
+        for (const auto &variable : environment) {
+            ::setenv(variable.first.c_str(), variable.second.c_str(), 1);
+        }
+
+        std::vector<char *> argv;
+        argv.push_back(const_cast<char *>(program.c_str()));
+        for (const auto &arg : args) {
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        // argv[0] is not a path when the program was started through PATH
+#if defined(__linux__)
+        ::execv("/proc/self/exe", argv.data());
+#endif
+        ::execvp(program.c_str(), argv.data());
+        std::cout << "Error: unable to run " << program << std::endl;
+        ::_exit(EXIT_FAILURE);
+    }
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+#endif
+
+} // namespace Benchmarks
+} // namespace Trueface
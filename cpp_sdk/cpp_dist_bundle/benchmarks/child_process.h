@@ -0,0 +1,72 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <cstdlib>
+#include <sys/wait.h>
+#include <type_traits>
+#include <unistd.h>
+#endif
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Evicts path from the page cache, a file or every file of a directory. Dropping the whole page
+// cache needs root, otherwise the clean pages of the files are released, which is enough as long
+// as nothing else maps them. An empty path only tries to drop the whole page cache.
+// Returns false when nothing could be evicted, and always on Windows and macOS.
+bool dropPageCache(const std::string &path);
+
+#if !defined(WIN32) && !defined(_WIN32)
+// Runs the executable of this process again in a child process, with program as argv[0] followed
+// by args, and the environment variables set on top of the current ones. The executable is found
+// even when it was started through PATH. Returns false if the child could not run or failed.
+bool runSelfInChild(const std::string &program, const std::vector<std::string> &args,
+                    const std::map<std::string, std::string> &environment);
+
+// Runs the measurement in a child process so that nothing is loaded yet, and sends the sample
+// back through a pipe. Returns false if the child failed.
+template <typename Sample>
+bool measureInChild(const std::function<bool(Sample &)> &measure, Sample &sample) {
+    static_assert(std::is_trivially_copyable<Sample>::value,
+                  "the sample is sent through a pipe and must be trivially copyable");
+    int fds[2];
+    if (::pipe(fds)) {
+        return false;
+    }
+
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        ::close(fds[0]);
+        Sample childSample{};
+        const bool ok = measure(childSample) &&
+                        ::write(fds[1], &childSample, sizeof(childSample)) ==
+                            static_cast<ssize_t>(sizeof(childSample));
+        ::close(fds[1]);
+        // skip the static destructors of the SDK, the parent does not care
+        ::_exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    ::close(fds[1]);
+    const auto numRead = ::read(fds[0], &sample, sizeof(sample));
+    ::close(fds[0]);
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return numRead == static_cast<ssize_t>(sizeof(sample)) && WIFEXITED(status) &&
+           WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+#endif
+
+} // namespace Benchmarks
+} // namespace Trueface
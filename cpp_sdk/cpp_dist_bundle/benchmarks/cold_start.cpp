@@ -0,0 +1,193 @@
+#include "child_process.h"
+#include "cold_start.h"
+#include "memory_high_water_mark.h"
+#include "stopwatch.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+enum class PageCache { COLD, WARM };
+
+struct ColdStartSample {
+    float constructorTime;
+    float setLicenseTime;
+    float firstInferenceTime;
+    // resident memory added by the measured step, in MB
+    float memoryUsage;
+};
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+bool measureEagerLoad(const SDKFactory &sdkFactory, const ConfigurationOptions &options,
+                      ColdStartSample &sample) {
+    const auto baseline = getResidentSetSize();
+    float constructorTime = 0.f;
+    float setLicenseTime = 0.f;
+    auto tfSdk = sdkFactory.createSDK(options, constructorTime, setLicenseTime);
+    sample.constructorTime = constructorTime;
+    sample.setLicenseTime = setLicenseTime;
+    sample.memoryUsage = getResidentSetSize() - baseline;
+    return true;
+}
+
+bool measureLazyFirstInference(const SDKFactory &sdkFactory, const ConfigurationOptions &options,
+                               const std::string &benchmarkName, const InferenceFactory &prepare,
+                               ColdStartSample &sample) {
+    auto lazyOptions = options;
+    lazyOptions.initializeModule = InitializeModule{};
+    auto tfSdk = sdkFactory.createSDK(lazyOptions);
+
+    Inference inference;
+    if (!prepare(tfSdk, inference)) {
+        return false;
+    }
+
+    const auto baseline = getResidentSetSize();
+    preciseStopwatch stopwatch;
+    auto errorCode = inference();
+    sample.firstInferenceTime = stopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+    sample.memoryUsage = getResidentSetSize() - baseline;
+
+    if (errorCode != ErrorCode::NO_ERROR) {
+        std::cout << "Error: Unable to run " << benchmarkName << std::endl;
+        std::cout << errorCode << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
+
+std::string joinSubType(const std::string &benchmarkSubType, const std::string &step,
+                        PageCache cache) {
+    std::string subType = benchmarkSubType.empty() ? "" : benchmarkSubType + ", ";
+    subType += step;
+    subType += cache == PageCache::COLD ? ", cold page cache" : ", warm page cache";
+    return subType;
+}
+
+MemoryProfile meanMemoryUsage(const std::vector<ColdStartSample> &samples) {
+    MemoryProfile memory{};
+    for (const auto &sample : samples) {
+        memory.memoryUsage += sample.memoryUsage;
+    }
+    if (!samples.empty()) {
+        memory.memoryUsage /= samples.size();
+    }
+    return memory;
+}
+
+} // namespace
+
+void runColdStart(const SDKFactory &sdkFactory, const ConfigurationOptions &options,
+                  const std::string &benchmarkName, const std::string &benchmarkSubType,
+                  const InferenceFactory &prepare, const Parameters &params,
+                  ObservationList &observations) {
+#if !defined(WIN32) && !defined(_WIN32)
+    // the cold start times are single measurements, so they are not divided by a batch size
+    auto coldStartParams = params;
+    coldStartParams.batchSize = 1;
+    coldStartParams.numThreads = 1;
+    coldStartParams.doWarmup = false;
+    coldStartParams.numWarmup = 0;
+    coldStartParams.numIterations = params.coldStart.numRepetitions;
+
+    for (auto cache : {PageCache::COLD, PageCache::WARM}) {
+        std::vector<ColdStartSample> eagerSamples;
+        std::vector<ColdStartSample> lazySamples;
+        for (unsigned int i = 0; i < params.coldStart.numRepetitions; ++i) {
+            if (cache == PageCache::COLD && !dropPageCache(options.modelsPath)) {
+                std::cout << "Unable to evict the model files from the page cache, skipping the "
+                             "cold page cache runs"
+                          << std::endl;
+                break;
+            }
+
+            ColdStartSample sample{};
+            if (!measureInChild<ColdStartSample>(
+                    [&](ColdStartSample &s) { return measureEagerLoad(sdkFactory, options, s); },
+                    sample)) {
+                std::cout << "Error: Unable to measure the eager load of " << benchmarkName
+                          << std::endl;
+                return;
+            }
+            eagerSamples.push_back(sample);
+
+            if (!prepare) {
+                continue;
+            }
+
+            if (cache == PageCache::COLD) {
+                dropPageCache(options.modelsPath);
+            }
+            sample = ColdStartSample{};
+            if (!measureInChild<ColdStartSample>(
+                    [&](ColdStartSample &s) {
+                        return measureLazyFirstInference(sdkFactory, options, benchmarkName,
+                                                         prepare, s);
+                    },
+                    sample)) {
+                std::cout << "Error: Unable to measure the first inference of " << benchmarkName
+                          << std::endl;
+                return;
+            }
+            lazySamples.push_back(sample);
+        }
+
+        if (eagerSamples.empty()) {
+            continue;
+        }
+
+        const auto version = SDK::getVersion();
+        const auto memoryUsage = meanMemoryUsage(eagerSamples);
+        std::vector<float> times;
+        if (!prepare) {
+            for (const auto &sample : eagerSamples) {
+                times.push_back(sample.constructorTime);
+            }
+            observations.emplace_back(version, sdkFactory.isGpuEnabled(), benchmarkName,
+                                      joinSubType(benchmarkSubType, "constructor", cache),
+                                      coldStartParams, times, memoryUsage);
+
+            times.clear();
+            for (const auto &sample : eagerSamples) {
+                times.push_back(sample.setLicenseTime);
+            }
+            observations.emplace_back(version, sdkFactory.isGpuEnabled(), benchmarkName,
+                                      joinSubType(benchmarkSubType, "setLicense", cache),
+                                      coldStartParams, times, memoryUsage);
+            continue;
+        }
+
+        for (const auto &sample : eagerSamples) {
+            times.push_back(sample.constructorTime + sample.setLicenseTime);
+        }
+        observations.emplace_back(version, sdkFactory.isGpuEnabled(), benchmarkName,
+                                  joinSubType(benchmarkSubType, "eager load", cache),
+                                  coldStartParams, times, memoryUsage);
+
+        times.clear();
+        for (const auto &sample : lazySamples) {
+            times.push_back(sample.firstInferenceTime);
+        }
+        observations.emplace_back(version, sdkFactory.isGpuEnabled(), benchmarkName,
+                                  joinSubType(benchmarkSubType, "lazy first inference", cache),
+                                  coldStartParams, times, meanMemoryUsage(lazySamples));
+    }
+#else
+    std::cout << "The cold start benchmark of " << benchmarkName
+              << " needs fork and is not supported on Windows" << std::endl;
+#endif
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
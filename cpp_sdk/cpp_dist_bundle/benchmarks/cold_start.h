@@ -0,0 +1,30 @@
+#pragma once
+
+#include "observation.h"
+#include "runner.h"
+#include "sdkfactory.h"
+
+#include <string>
+
+// fwd declarations
+namespace Trueface {
+struct ConfigurationOptions;
+} // namespace Trueface
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Measures the startup cost of a benchmark, each repetition in a fresh child process, first with
+// the model files evicted from the page cache and then with a warm page cache:
+// * eager load: the SDK constructor and setLicense with the initializeModule options of the
+//   benchmark, and the resident memory they add.
+// * lazy first inference: the first inference of an SDK without initializeModule options, after
+//   the inputs were prepared, and the resident memory it adds.
+// When prepare is empty, only the SDK constructor and setLicense are measured.
+void runColdStart(const SDKFactory &sdkFactory, const Trueface::ConfigurationOptions &options,
+                  const std::string &benchmarkName, const std::string &benchmarkSubType,
+                  const InferenceFactory &prepare, const Parameters &params,
+                  ObservationList &observations);
+
+} // namespace Benchmarks
+} // namespace Trueface
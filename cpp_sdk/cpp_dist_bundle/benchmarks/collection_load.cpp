@@ -0,0 +1,253 @@
+#include "child_process.h"
+#include "collection_load.h"
+#include "memory_high_water_mark.h"
+#include "stopwatch.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+enum class PageCache { COLD, WARM };
+
+enum class LoadMethod { CREATE_LOAD_COLLECTION, LOAD_COLLECTIONS };
+
+struct Backend {
+    DatabaseManagementSystem dbms;
+    const char *name;
+    std::string connection;
+};
+
+struct LoadSample {
+    float connectTime;
+    float loadTime;
+    // growth of the peak resident memory over the load, and the largest resident set size
+    // sampled, in MB
+    float memoryUsage;
+    float peakRss;
+};
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+ConfigurationOptions createOptions(const SDKFactory &sdkFactory, DatabaseManagementSystem dbms,
+                                   bool isEncrypted, const std::string &encryptionKey) {
+    auto options = sdkFactory.createBasicConfiguration();
+    options.frModel = FacialRecognitionModel::TFV7;
+    options.frVectorCompression = false;
+    options.dbms = dbms;
+    options.encryptDatabase.enableEncryption = isEncrypted;
+    options.encryptDatabase.key = encryptionKey;
+    return options;
+}
+
+// Replaces the collection with collectionSize distinct synthetic templates
+bool populateCollection(const SDKFactory &sdkFactory, const ConfigurationOptions &options,
+                        const std::string &connection, const std::string &collectionName,
+                        size_t collectionSize, const TemplateGeneratorOptions &generatorOptions) {
+    auto tfSdk = sdkFactory.createSDK(options);
+    if (tfSdk.createDatabaseConnection(connection) != ErrorCode::NO_ERROR) {
+        std::cout << "Unable to connect to the database" << std::endl;
+        return false;
+    }
+
+    // A real template gives the size and the metadata of the generated ones
+    TFImage img;
+    Faceprint prototype;
+    bool foundFace = false;
+    if (tfSdk.preprocessImage("../images/headshot.jpg", img) != ErrorCode::NO_ERROR ||
+        tfSdk.getLargestFaceFeatureVector(img, prototype, foundFace) != ErrorCode::NO_ERROR ||
+        !foundFace) {
+        std::cout << "Unable to detect face and extract features" << std::endl;
+        return false;
+    }
+
+    // the collection does not exist on the first run
+    tfSdk.deleteCollection(collectionName);
+    if (tfSdk.createLoadCollection(collectionName) != ErrorCode::NO_ERROR) {
+        std::cout << "Error creating collection" << std::endl;
+        return false;
+    }
+
+    TemplateGenerator generator{prototype, generatorOptions};
+    std::vector<float> center;
+    Faceprint faceprint;
+    for (uint64_t identity = 0; identity < collectionSize; ++identity) {
+        generator.generateIdentity(identity, center);
+        generator.generateTemplate(center, identity, 0, faceprint);
+        std::string UUID;
+        if (tfSdk.enrollFaceprint(faceprint, TemplateGenerator::getIdentityName(identity), UUID) !=
+            ErrorCode::NO_ERROR) {
+            std::cout << "Unable to enroll template" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool measureLoad(const SDKFactory &sdkFactory, const ConfigurationOptions &options,
+                 const std::string &connection, const std::string &collectionName,
+                 LoadMethod method, LoadSample &sample) {
+    auto tfSdk = sdkFactory.createSDK(options);
+
+    MemoryHighWaterMarkTracker memoryTracker;
+    preciseStopwatch stopwatch;
+    if (tfSdk.createDatabaseConnection(connection) != ErrorCode::NO_ERROR) {
+        std::cout << "Unable to connect to the database" << std::endl;
+        return false;
+    }
+    sample.connectTime = stopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+
+    stopwatch = preciseStopwatch();
+    const auto errorCode = method == LoadMethod::CREATE_LOAD_COLLECTION
+                               ? tfSdk.createLoadCollection(collectionName)
+                               : tfSdk.loadCollections({collectionName});
+    sample.loadTime = stopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+    if (errorCode != ErrorCode::NO_ERROR) {
+        std::cout << "Unable to load the collection" << std::endl;
+        return false;
+    }
+
+    sample.memoryUsage = memoryTracker.getDifferenceFromBaseline();
+    sample.peakRss = memoryTracker.getPeakRss();
+    return true;
+}
+
+#endif
+
+std::string getSubType(const Backend &backend, bool isEncrypted, size_t collectionSize,
+                       const std::string &step, PageCache cache) {
+    return std::string(backend.name) + (isEncrypted ? " encrypted" : "") + " (" +
+           std::to_string(collectionSize) + "), " + step +
+           (cache == PageCache::COLD ? ", cold page cache" : ", warm page cache");
+}
+
+} // namespace
+
+void runCollectionLoadBenchmark(const SDKFactory &sdkFactory, const CollectionLoadOptions &options,
+                                ObservationList &observations) {
+#if !defined(WIN32) && !defined(_WIN32)
+    std::vector<Backend> backends{{DatabaseManagementSystem::SQLITE, "SQLite", ""}};
+    if (!options.postgresConnection.empty()) {
+        backends.push_back(
+            {DatabaseManagementSystem::POSTGRESQL, "PostgreSQL", options.postgresConnection});
+    } else {
+        std::cout << "No PostgreSQL connection string, skipping the PostgreSQL backend"
+                  << std::endl;
+    }
+
+    auto params =
+        Parameters{false, 0, 1, options.numRepetitions, 1, {}, {}, {0, true}, {}, {}};
+    for (const auto &backend : backends) {
+        for (bool isEncrypted : {false, true}) {
+            // encrypted and plain collections do not share a SQLite file
+            std::string connection = backend.connection;
+            if (backend.dbms == DatabaseManagementSystem::SQLITE) {
+                connection = isEncrypted ? options.sqlitePath + ".encrypted" : options.sqlitePath;
+            }
+            const auto sdkOptions =
+                createOptions(sdkFactory, backend.dbms, isEncrypted, options.encryptionKey);
+
+            for (auto collectionSize : options.collectionSizes) {
+                const std::string collectionName = "load_benchmark_" +
+                                                   std::to_string(collectionSize) +
+                                                   (isEncrypted ? "_encrypted" : "");
+                std::cout << "Populating " << backend.name << (isEncrypted ? " encrypted" : "")
+                          << " collection with " << collectionSize << " templates" << std::endl;
+
+                // populate in a child too, so the parent never loads the SDK before forking
+                int unused = 0;
+                if (!measureInChild<int>(
+                        [&](int &) {
+                            return populateCollection(sdkFactory, sdkOptions, connection,
+                                                      collectionName, collectionSize,
+                                                      options.generator);
+                        },
+                        unused)) {
+                    std::cout << "Error: unable to populate the collection" << std::endl;
+                    return;
+                }
+
+                for (auto cache : {PageCache::COLD, PageCache::WARM}) {
+                    for (auto method :
+                         {LoadMethod::CREATE_LOAD_COLLECTION, LoadMethod::LOAD_COLLECTIONS}) {
+                        std::vector<LoadSample> samples;
+                        for (unsigned int i = 0; i < options.numRepetitions; ++i) {
+                            // the PostgreSQL server keeps its own buffers warm, only the page
+                            // cache of the machine is dropped
+                            if (cache == PageCache::COLD &&
+                                !dropPageCache(backend.dbms == DatabaseManagementSystem::SQLITE
+                                                   ? connection
+                                                   : "")) {
+                                std::cout << "Unable to drop the page cache, skipping the cold "
+                                             "page cache runs"
+                                          << std::endl;
+                                break;
+                            }
+                            LoadSample sample{};
+                            if (!measureInChild<LoadSample>(
+                                    [&](LoadSample &s) {
+                                        return measureLoad(sdkFactory, sdkOptions, connection,
+                                                           collectionName, method, s);
+                                    },
+                                    sample)) {
+                                std::cout << "Error: unable to measure the collection load"
+                                          << std::endl;
+                                return;
+                            }
+                            samples.push_back(sample);
+                        }
+                        if (samples.empty()) {
+                            continue;
+                        }
+
+                        MemoryProfile memory{};
+                        std::vector<float> connectTimes;
+                        std::vector<float> loadTimes;
+                        for (const auto &sample : samples) {
+                            connectTimes.push_back(sample.connectTime);
+                            loadTimes.push_back(sample.loadTime);
+                            memory.memoryUsage += sample.memoryUsage / samples.size();
+                            memory.peakRss = std::max(memory.peakRss, sample.peakRss);
+                        }
+                        params.numIterations = samples.size();
+
+                        const std::string benchmarkName = "1 to N collection load";
+                        const std::string step = method == LoadMethod::CREATE_LOAD_COLLECTION
+                                                     ? "createLoadCollection"
+                                                     : "loadCollections";
+                        observations.emplace_back(
+                            SDK::getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
+                            getSubType(backend, isEncrypted, collectionSize, step, cache),
+                            params, loadTimes, memory);
+                        if (method == LoadMethod::CREATE_LOAD_COLLECTION) {
+                            observations.emplace_back(
+                                SDK::getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
+                                getSubType(backend, isEncrypted, collectionSize,
+                                           "createDatabaseConnection", cache),
+                                params, connectTimes, MemoryProfile{});
+                        }
+                    }
+                }
+            }
+        }
+    }
+#else
+    (void)sdkFactory;
+    (void)options;
+    (void)observations;
+    std::cout << "The collection load benchmark needs fork and is not supported on Windows"
+              << std::endl;
+#endif
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
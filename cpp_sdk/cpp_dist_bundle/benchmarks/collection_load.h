@@ -0,0 +1,33 @@
+#pragma once
+
+#include "observation.h"
+#include "sdkfactory.h"
+#include "template_generator.h"
+
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+struct CollectionLoadOptions {
+    // SQLite database file, the encrypted collections go to a second file next to it
+    std::string sqlitePath;
+    // PostgreSQL connection string, the PostgreSQL backend is skipped when empty
+    std::string postgresConnection;
+    std::string encryptionKey;
+    std::vector<size_t> collectionSizes;
+    unsigned int numRepetitions;
+    TemplateGeneratorOptions generator;
+};
+
+// Measures how long a restarted service takes to get a persisted collection back into memory.
+// For every backend, with encryption off and on, and every collection size, a collection of
+// distinct synthetic templates is enrolled, then createLoadCollection and loadCollections are
+// timed in fresh child processes, first with a cold and then with a warm page cache, along with
+// the resident memory and the peak resident memory they add.
+void runCollectionLoadBenchmark(const SDKFactory &sdkFactory, const CollectionLoadOptions &options,
+                                ObservationList &observations);
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,154 @@
+// Compares two raw times files written by `run_benchmarks --raw-times` and reports the speedups
+// and regressions of every benchmark found in both files.
+// Exits with a non zero code if any benchmark regressed, so it can be used as a regression gate.
+
+#include "raw_times.h"
+#include "statistics.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Trueface::Benchmarks;
+
+namespace {
+
+// Samples in ms, keyed by the name of their series
+std::map<std::string, std::vector<float>> groupBySeries(const RawTimesFile &file) {
+    std::map<std::string, std::vector<float>> samples;
+    for (const auto &time : file.times) {
+        samples[getSeriesName(time)].push_back(time.time);
+    }
+    return samples;
+}
+
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program
+              << " BASELINE.csv CANDIDATE.csv [--alpha A] [--min-change PERCENT] [--force]"
+              << std::endl;
+    std::cout << "  BASELINE.csv, CANDIDATE.csv  files written by run_benchmarks --raw-times"
+              << std::endl;
+    std::cout << "  --alpha A             significance level of the Mann-Whitney U test "
+                 "(default 0.05)"
+              << std::endl;
+    std::cout << "  --min-change PERCENT  smallest change of the median reported as a speedup or "
+                 "regression (default 2)"
+              << std::endl;
+    std::cout << "  --force               compare results from different machines" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> paths;
+    double alpha = 0.05;
+    double minChange = 0.02;
+    bool force = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+            alpha = std::stod(argv[++i]);
+        } else if (std::strcmp(argv[i], "--min-change") == 0 && i + 1 < argc) {
+            minChange = std::stod(argv[++i]) / 100.0;
+        } else if (std::strcmp(argv[i], "--force") == 0) {
+            force = true;
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (paths.size() != 2) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    RawTimesFile baseline;
+    RawTimesFile candidate;
+    if (!readRawTimesFile(paths[0], baseline) || !readRawTimesFile(paths[1], candidate)) {
+        return EXIT_FAILURE;
+    }
+    const auto baselineSamples = groupBySeries(baseline);
+    const auto candidateSamples = groupBySeries(candidate);
+
+    const auto baselineHost = getMetadata(baseline, "Host Fingerprint");
+    const auto candidateHost = getMetadata(candidate, "Host Fingerprint");
+    if (baselineHost != candidateHost) {
+        std::cout << "The results were recorded on different machines:" << std::endl;
+        std::cout << "  baseline:  " << getMetadata(baseline, "CPU Model") << ", "
+                  << getMetadata(baseline, "Cores") << " cores, "
+                  << getMetadata(baseline, "ISA Flags") << std::endl;
+        std::cout << "  candidate: " << getMetadata(candidate, "CPU Model") << ", "
+                  << getMetadata(candidate, "Cores") << " cores, "
+                  << getMetadata(candidate, "ISA Flags") << std::endl;
+        if (!force) {
+            std::cout << "Refusing to compare them, pass --force to compare anyway." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto baselineVersion = getMetadata(baseline, "SDK Version");
+    const auto candidateVersion = getMetadata(candidate, "SDK Version");
+    std::cout << "SDK version: " << baselineVersion;
+    if (candidateVersion != baselineVersion) {
+        std::cout << " -> " << candidateVersion;
+    }
+    std::cout << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(70) << "Benchmark" << std::right << std::setw(14)
+              << "Baseline (ms)" << std::setw(15) << "Candidate (ms)" << std::setw(10)
+              << "Speedup" << std::setw(20) << "95% CI" << std::setw(10) << "p-value"
+              << "  Result" << std::endl;
+
+    int numRegressions = 0;
+    for (const auto &entry : baselineSamples) {
+        const auto &key = entry.first;
+        auto it = candidateSamples.find(key);
+        if (it == candidateSamples.end()) {
+            std::cout << std::left << std::setw(70) << key << " only in baseline" << std::endl;
+            continue;
+        }
+
+        const auto &baselineTimes = entry.second;
+        const auto &candidateTimes = it->second;
+
+        // speedup > 1 means the candidate is faster
+        const auto speedup = bootstrapMedianRatio(baselineTimes, candidateTimes, 0.95);
+        const auto test = mannWhitneyU(baselineTimes, candidateTimes);
+
+        const bool isSignificant = test.pValue < alpha;
+        std::string result = "no change";
+        if (isSignificant && speedup.low > 1.0 && speedup.estimate - 1.0 >= minChange) {
+            result = "faster";
+        } else if (isSignificant && speedup.high < 1.0 && 1.0 - speedup.estimate >= minChange) {
+            result = "REGRESSION";
+            ++numRegressions;
+        }
+
+        std::ostringstream ci;
+        ci << std::fixed << std::setprecision(3) << "[" << speedup.low << ", " << speedup.high
+           << "]";
+
+        std::cout << std::left << std::setw(70) << key << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(14) << median(baselineTimes)
+                  << std::setw(15) << median(candidateTimes) << std::setw(9) << speedup.estimate
+                  << "x" << std::setw(20) << ci.str() << std::setw(10) << std::setprecision(4)
+                  << test.pValue << "  " << result << std::endl;
+    }
+
+    for (const auto &entry : candidateSamples) {
+        if (baselineSamples.find(entry.first) == baselineSamples.end()) {
+            std::cout << std::left << std::setw(70) << entry.first << " only in candidate"
+                      << std::endl;
+        }
+    }
+
+    std::cout << std::endl << numRegressions << " regression(s)" << std::endl;
+    return numRegressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
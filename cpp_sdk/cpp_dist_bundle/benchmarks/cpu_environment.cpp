@@ -0,0 +1,295 @@
+#include "cpu_environment.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+// Set by restartPinnedToCpus for the program it runs
+const char *const pinnedEnvironmentVariable = "TF_BENCHMARKS_PINNED_CPUS";
+
+#if defined(__linux__)
+const std::string cgroupRoot{"/sys/fs/cgroup"};
+const std::string cpuRoot{"/sys/devices/system/cpu"};
+
+bool readLine(const std::string &path, std::string &line) {
+    std::ifstream file{path};
+    return static_cast<bool>(std::getline(file, line));
+}
+
+// Parses a kernel CPU list such as "0-3,8"
+std::vector<int> parseCpuList(const std::string &cpuList) {
+    std::vector<int> cpus;
+    std::istringstream stream{cpuList};
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        const auto dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<int> getAllowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+// Directory of the cgroup v2 of the process, empty when it is not in a cgroup v2 hierarchy
+std::string getCgroupPath() {
+    std::ifstream file{"/proc/self/cgroup"};
+    std::string line;
+    while (std::getline(file, line)) {
+        // the unified hierarchy is the "0::/path" entry
+        if (line.compare(0, 3, "0::") == 0) {
+            std::string path = cgroupRoot + line.substr(3);
+            while (path.size() > cgroupRoot.size() && path.back() == '/') {
+                path.pop_back();
+            }
+            return path;
+        }
+    }
+    return "";
+}
+
+// The quota of a cgroup applies to its children, so the cgroups up to the root are read too
+void readCgroupCpu(CpuEnvironment &environment) {
+    std::string path = getCgroupPath();
+    while (!path.empty()) {
+        std::string cpuMax;
+        if (readLine(path + "/cpu.max", cpuMax) && cpuMax.compare(0, 3, "max") != 0) {
+            std::istringstream values{cpuMax};
+            double quota = 0.0;
+            double period = 0.0;
+            if (values >> quota >> period && period > 0.0) {
+                const float cores = static_cast<float>(quota / period);
+                if (environment.cpuQuota == 0.f || cores < environment.cpuQuota) {
+                    environment.cpuQuota = cores;
+                }
+            }
+
+            std::ifstream cpuStat{path + "/cpu.stat"};
+            std::string key;
+            uint64_t value = 0;
+            while (cpuStat >> key >> value) {
+                if (key == "nr_throttled") {
+                    environment.throttledPeriods += value;
+                } else if (key == "throttled_usec") {
+                    environment.throttledTime += value;
+                }
+            }
+        }
+
+        if (path.size() <= cgroupRoot.size()) {
+            break;
+        }
+        path = path.substr(0, path.find_last_of('/'));
+    }
+}
+
+void readCpuFrequency(CpuEnvironment &environment) {
+    double totalFrequency = 0.0;
+    size_t numFrequencies = 0;
+    std::vector<std::string> governors;
+    for (auto cpu : environment.allowedCpus) {
+        const std::string cpufreq = cpuRoot + "/cpu" + std::to_string(cpu) + "/cpufreq/";
+        std::string line;
+        if (readLine(cpufreq + "scaling_cur_freq", line)) {
+            // in kHz
+            totalFrequency += std::stod(line) / 1000.0;
+            ++numFrequencies;
+        }
+        if (readLine(cpufreq + "scaling_governor", line) &&
+            std::find(governors.begin(), governors.end(), line) == governors.end()) {
+            governors.push_back(line);
+        }
+    }
+    if (numFrequencies) {
+        environment.frequency = static_cast<float>(totalFrequency / numFrequencies);
+    }
+    for (size_t i = 0; i < governors.size(); ++i) {
+        environment.governor += (i ? "/" : "") + governors[i];
+    }
+}
+#endif
+
+// Collapses consecutive CPUs into ranges, the reverse of parseCpuList
+std::string formatCpuList(const std::vector<int> &cpus) {
+    std::string cpuList;
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        size_t last = i;
+        while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) {
+            ++last;
+        }
+        cpuList += (cpuList.empty() ? "" : ",") + std::to_string(cpus[i]);
+        if (last > i) {
+            cpuList += "-" + std::to_string(cpus[last]);
+        }
+        i = last;
+    }
+    return cpuList;
+}
+
+} // namespace
+
+CpuEnvironment CpuEnvironment::capture() {
+    CpuEnvironment environment{false, 0.f, 0, 0, 0.f, "", -1, {}};
+#if defined(__linux__)
+    environment.isAvailable = true;
+    environment.allowedCpus = getAllowedCpus();
+    readCgroupCpu(environment);
+    readCpuFrequency(environment);
+    std::string smtActive;
+    if (readLine(cpuRoot + "/smt/active", smtActive) && !smtActive.empty()) {
+        environment.smtActive = smtActive[0] == '1' ? 1 : 0;
+    }
+#endif
+    return environment;
+}
+
+std::string describe(const CpuEnvironment &environment) {
+    if (!environment.isAvailable) {
+        return "CPU environment not available";
+    }
+    std::ostringstream description;
+    description << std::fixed << std::setprecision(2);
+    if (environment.cpuQuota > 0.f) {
+        description << "CPU quota " << environment.cpuQuota << " cores";
+    } else {
+        description << "no CPU quota";
+    }
+    if (environment.frequency > 0.f) {
+        description << " | " << std::setprecision(0) << environment.frequency << " MHz";
+    }
+    if (!environment.governor.empty()) {
+        description << " | governor " << environment.governor;
+    }
+    if (environment.smtActive >= 0) {
+        description << " | SMT " << (environment.smtActive ? "on" : "off");
+    }
+    description << " | CPUs " << formatCpuList(environment.allowedCpus);
+    return description.str();
+}
+
+void CpuEnvironmentMonitor::start() { m_before = CpuEnvironment::capture(); }
+
+void CpuEnvironmentMonitor::stop() { m_after = CpuEnvironment::capture(); }
+
+CpuEnvironmentResult CpuEnvironmentMonitor::getResult() const {
+    CpuEnvironmentResult result{};
+    result.smtActive = -1;
+    if (!m_before.isAvailable || !m_after.isAvailable) {
+        return result;
+    }
+
+    result.isAvailable = true;
+    result.cpuQuota = m_after.cpuQuota;
+    // the counters of a cgroup created in between are not comparable
+    if (m_after.throttledPeriods >= m_before.throttledPeriods &&
+        m_after.throttledTime >= m_before.throttledTime) {
+        result.throttledPeriods = m_after.throttledPeriods - m_before.throttledPeriods;
+        result.throttledTime = (m_after.throttledTime - m_before.throttledTime) / 1000.f;
+    }
+    result.frequencyBefore = m_before.frequency;
+    result.frequencyAfter = m_after.frequency;
+    result.governor = m_after.governor;
+    result.smtActive = m_after.smtActive;
+    result.numAllowedCpus = static_cast<unsigned int>(m_after.allowedCpus.size());
+    result.isThrottled = result.throttledPeriods > 0;
+    result.isFrequencyDropped = m_before.frequency > 0.f && m_after.frequency > 0.f &&
+                                m_after.frequency < 0.9f * m_before.frequency;
+    return result;
+}
+
+unsigned int getUsableCpuCount() {
+    const auto environment = CpuEnvironment::capture();
+    auto numCpus = static_cast<unsigned int>(environment.allowedCpus.size());
+    if (!numCpus) {
+        numCpus = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // a fraction of a core cannot run another thread without oversubscribing
+    if (environment.cpuQuota > 0.f) {
+        numCpus = std::min(numCpus, std::max(1u, static_cast<unsigned int>(environment.cpuQuota)));
+    }
+    return numCpus;
+}
+
+bool restartPinnedToCpus(const std::string &cpuList, char *argv[]) {
+#if defined(__linux__)
+    std::string cpus = cpuList;
+    if (cpuList == "isolated" && (!readLine(cpuRoot + "/isolated", cpus) || cpus.empty())) {
+        std::cout << "Error: the kernel has no isolated CPUs, boot it with isolcpus= or give the "
+                     "CPUs to pin to"
+                  << std::endl;
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::vector<int> pinned;
+    try {
+        pinned = parseCpuList(cpus);
+    } catch (const std::exception &) {
+        pinned.clear();
+    }
+    for (auto cpu : pinned) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (pinned.empty() || ::sched_setaffinity(0, sizeof(set), &set) != 0) {
+        std::cout << "Error: unable to pin the benchmarks to the CPUs " << cpus << std::endl;
+        return false;
+    }
+
+    // the CPUs which do not exist are dropped. The affinity is kept across exec.
+    pinned = getAllowedCpus();
+    const auto numCpus = std::to_string(pinned.size());
+    ::setenv("OMP_NUM_THREADS", numCpus.c_str(), 0);
+    ::setenv(pinnedEnvironmentVariable, formatCpuList(pinned).c_str(), 1);
+    std::cout << "Pinned the benchmarks to the CPUs " << formatCpuList(pinned) << ", running "
+              << std::getenv("OMP_NUM_THREADS") << " inference threads" << std::endl;
+
+    ::execv("/proc/self/exe", argv);
+    std::cout << "Error: unable to run " << argv[0] << " again on the pinned CPUs" << std::endl;
+    return false;
+#else
+    (void)cpuList;
+    (void)argv;
+    std::cout << "Error: pinning to CPUs is only supported on Linux" << std::endl;
+    return false;
+#endif
+}
+
+bool isPinnedToCpus() { return std::getenv(pinnedEnvironmentVariable) != nullptr; }
+
+} // namespace Benchmarks
+} // namespace Trueface
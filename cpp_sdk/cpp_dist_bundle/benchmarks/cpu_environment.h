@@ -0,0 +1,67 @@
+#pragma once
+
+#include "observation.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// What limits the CPU time and speed of the process at one point in time, as far as Linux tells.
+// Nothing is read on Windows and macOS.
+struct CpuEnvironment {
+    bool isAvailable;
+    // Tightest cpu.max quota of the cgroup v2 of the process and its parents, in cores. 0 when
+    // unlimited.
+    float cpuQuota;
+    // Throttling counters of cpu.stat, summed over the cgroups with a quota
+    uint64_t throttledPeriods;
+    // in us
+    uint64_t throttledTime;
+    // Mean current frequency of the CPUs the process may run on in MHz, 0 when unknown
+    float frequency;
+    // cpufreq governors of those CPUs, separated by a slash when they differ
+    std::string governor;
+    // 1 when simultaneous multithreading is active, 0 when not, -1 when unknown
+    int smtActive;
+    std::vector<int> allowedCpus;
+
+    static CpuEnvironment capture();
+};
+
+// One line summary, such as "CPU quota 2 cores | governor performance | SMT on | CPUs 0-7"
+std::string describe(const CpuEnvironment &);
+
+// Captures the environment when the timed iterations start and stop, to flag the observations
+// which were throttled by the quota of the cgroup or ran at a lower frequency than they started.
+class CpuEnvironmentMonitor {
+public:
+    void start();
+    void stop();
+
+    CpuEnvironmentResult getResult() const;
+
+private:
+    CpuEnvironment m_before;
+    CpuEnvironment m_after;
+};
+
+// Number of CPUs the process can keep busy: the CPUs it may run on, capped by the quota of its
+// cgroup. The number of cores where they are not known.
+unsigned int getUsableCpuCount();
+
+// Restricts the process to the CPUs of cpuList, such as "2-5,8", or to the isolated CPUs of the
+// kernel (isolcpus) when cpuList is "isolated", and runs the program again with argv. The OpenMP
+// runtime sizes its thread team from the CPUs it may run on when it is loaded, which is before
+// main, so only a new program image runs as many inference threads as there are pinned CPUs.
+// OMP_NUM_THREADS is set to the number of pinned CPUs unless it is already set. Does not return
+// unless the restriction or the exec fails, and then returns false.
+bool restartPinnedToCpus(const std::string &cpuList, char *argv[]);
+
+// True in the program started by restartPinnedToCpus
+bool isPinnedToCpus();
+
+} // namespace Benchmarks
+} // namespace Trueface
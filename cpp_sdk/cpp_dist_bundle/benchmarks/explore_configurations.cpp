@@ -0,0 +1,601 @@
+// Sweeps the configuration options which trade speed for accuracy over a labeled image set, and
+// reports the throughput, face detection recall and verification accuracy of every combination
+// along with the configurations no other one beats on all three.
+
+#include "host_info.h"
+#include "observation.h"
+#include "sdkfactory.h"
+#include "stopwatch.h"
+
+#include "tf_sdk.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+using namespace Trueface;
+
+namespace {
+
+const std::string benchmarkName{"Configuration explorer"};
+
+template <typename T> struct NamedValue {
+    const char *name;
+    T value;
+};
+
+const NamedValue<FaceDetectionModel> fdModelNames[] = {{"FAST", FaceDetectionModel::FAST},
+                                                       {"ACCURATE", FaceDetectionModel::ACCURATE}};
+const NamedValue<FaceDetectionFilter> fdFilterNames[] = {
+    {"BALANCED", FaceDetectionFilter::BALANCED},
+    {"HIGH_RECALL", FaceDetectionFilter::HIGH_RECALL},
+    {"HIGH_PRECISION", FaceDetectionFilter::HIGH_PRECISION}};
+const NamedValue<FacialRecognitionModel> frModelNames[] = {
+    {"LITE_V2", FacialRecognitionModel::LITE_V2},
+    {"LITE_V3", FacialRecognitionModel::LITE_V3},
+    {"TFV5_2", FacialRecognitionModel::TFV5_2},
+    {"TFV6", FacialRecognitionModel::TFV6},
+    {"TFV7", FacialRecognitionModel::TFV7}};
+const NamedValue<ObjectDetectionModel> objModelNames[] = {
+    {"FAST", ObjectDetectionModel::FAST}, {"ACCURATE", ObjectDetectionModel::ACCURATE}};
+const NamedValue<bool> compressionNames[] = {{"off", false}, {"on", true}};
+
+template <typename T, size_t N> const char *getName(const NamedValue<T> (&names)[N], T value) {
+    for (const auto &name : names) {
+        if (name.value == value) {
+            return name.name;
+        }
+    }
+    return "unknown";
+}
+
+template <typename T, size_t N>
+bool parseList(const std::string &list, const NamedValue<T> (&names)[N], std::vector<T> &values) {
+    values.clear();
+    std::istringstream stream{list};
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        auto it = std::find_if(std::begin(names), std::end(names), [&](const NamedValue<T> &name) {
+            return item == name.name;
+        });
+        if (it == std::end(names)) {
+            std::cout << "Error: unknown value " << item << std::endl;
+            return false;
+        }
+        values.push_back(it->value);
+    }
+    return !values.empty();
+}
+
+bool parseList(const std::string &list, std::vector<unsigned int> &values) {
+    values.clear();
+    std::istringstream stream{list};
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(std::stoul(item));
+    }
+    return !values.empty();
+}
+
+struct ExplorerOptions {
+    std::string datasetPath;
+    std::vector<FaceDetectionModel> fdModels;
+    std::vector<FaceDetectionFilter> fdFilters;
+    std::vector<unsigned int> smallestFaceHeights;
+    std::vector<FacialRecognitionModel> frModels;
+    std::vector<bool> frVectorCompressions;
+    // detectObjects is only part of the timed chain, and objModel only swept, when enabled
+    bool detectObjects;
+    std::vector<ObjectDetectionModel> objModels;
+    // False match rate the threshold of every configuration is chosen for
+    float targetFmr;
+    // Impostor pairs beyond which a random sample of them is compared
+    size_t maxImpostorPairs;
+    unsigned int numWarmup;
+};
+
+// An image of the dataset, holding a single labeled face
+struct LabeledImage {
+    std::string path;
+    std::string identity;
+};
+
+bool isImageFile(const std::string &path) {
+    const auto dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == "jpg" || extension == "jpeg" || extension == "png" || extension == "bmp";
+}
+
+// The dataset has a directory per identity holding the images of that identity
+bool findLabeledImages(const std::string &datasetPath, std::vector<LabeledImage> &images) {
+#if !defined(WIN32) && !defined(_WIN32)
+    DIR *dataset = opendir(datasetPath.c_str());
+    if (!dataset) {
+        std::cout << "Error: could not open the directory " << datasetPath << std::endl;
+        return false;
+    }
+    while (dirent *identityEntry = readdir(dataset)) {
+        const std::string identity = identityEntry->d_name;
+        const std::string identityPath = datasetPath + "/" + identity;
+        struct stat status;
+        if (identity == "." || identity == ".." || stat(identityPath.c_str(), &status) != 0 ||
+            !S_ISDIR(status.st_mode)) {
+            continue;
+        }
+        DIR *identityDir = opendir(identityPath.c_str());
+        if (!identityDir) {
+            continue;
+        }
+        while (dirent *imageEntry = readdir(identityDir)) {
+            const std::string path = identityPath + "/" + imageEntry->d_name;
+            if (stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode) && isImageFile(path)) {
+                images.push_back({path, identity});
+            }
+        }
+        closedir(identityDir);
+    }
+    closedir(dataset);
+    std::sort(images.begin(), images.end(), [](const LabeledImage &a, const LabeledImage &b) {
+        return a.path < b.path;
+    });
+    return true;
+#else
+    (void)datasetPath;
+    (void)images;
+    std::cout << "Error: the configuration explorer is not supported on Windows" << std::endl;
+    return false;
+#endif
+}
+
+struct ComparisonPairs {
+    std::vector<std::pair<size_t, size_t>> genuine;
+    std::vector<std::pair<size_t, size_t>> impostor;
+};
+
+// Every pair of images of the same identity, and every pair of different identities up to
+// maxImpostorPairs, past which they are sampled with a fixed seed so that every configuration
+// compares the same pairs
+ComparisonPairs getComparisonPairs(const std::vector<LabeledImage> &images,
+                                   size_t maxImpostorPairs) {
+    ComparisonPairs pairs;
+    size_t numImpostorPairs = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        for (size_t j = i + 1; j < images.size(); ++j) {
+            if (images[i].identity == images[j].identity) {
+                pairs.genuine.emplace_back(i, j);
+            } else {
+                ++numImpostorPairs;
+            }
+        }
+    }
+
+    if (numImpostorPairs <= maxImpostorPairs) {
+        for (size_t i = 0; i < images.size(); ++i) {
+            for (size_t j = i + 1; j < images.size(); ++j) {
+                if (images[i].identity != images[j].identity) {
+                    pairs.impostor.emplace_back(i, j);
+                }
+            }
+        }
+        return pairs;
+    }
+
+    std::mt19937_64 engine{1};
+    std::uniform_int_distribution<size_t> distribution{0, images.size() - 1};
+    while (pairs.impostor.size() < maxImpostorPairs) {
+        const size_t i = distribution(engine);
+        const size_t j = distribution(engine);
+        if (images[i].identity != images[j].identity) {
+            pairs.impostor.emplace_back(i, j);
+        }
+    }
+    return pairs;
+}
+
+struct ConfigurationResult {
+    ConfigurationOptions options;
+    std::string name;
+    float imagesPerSecond;
+    float meanTime;
+    // Fraction of the images in which a face is detected
+    float recall;
+    // Similarity threshold for the target false match rate, and the error rates at it
+    float threshold;
+    float fmr;
+    float fnmr;
+    bool isParetoOptimal;
+};
+
+std::string getConfigurationName(const ConfigurationOptions &options, bool detectObjects) {
+    std::ostringstream name;
+    name << "fd " << getName(fdModelNames, options.fdModel) << " "
+         << getName(fdFilterNames, options.fdFilter) << " " << options.smallestFaceHeight
+         << "px, fr " << getName(frModelNames, options.frModel) << " compression "
+         << getName(compressionNames, options.frVectorCompression);
+    if (detectObjects) {
+        name << ", obj " << getName(objModelNames, options.objModel);
+    }
+    return name.str();
+}
+
+// Detects the faces of the image, then extracts the templates of all of them like a service
+// would, and keeps the template of the largest face as the one of the labeled identity
+ErrorCode processImage(SDK &tfSdk, const TFImage &img, bool detectObjects, bool &found,
+                       Faceprint &faceprint) {
+    std::vector<FaceBoxAndLandmarks> faces;
+    auto errorCode = tfSdk.detectFaces(img, faces);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    if (detectObjects) {
+        std::vector<BoundingBox> boundingBoxes;
+        errorCode = tfSdk.detectObjects(img, boundingBoxes);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            return errorCode;
+        }
+    }
+    found = !faces.empty();
+    if (!found) {
+        return ErrorCode::NO_ERROR;
+    }
+
+    std::vector<TFFacechip> facechips(faces.size());
+    for (size_t i = 0; i < faces.size(); ++i) {
+        errorCode = tfSdk.extractAlignedFace(img, faces[i], facechips[i]);
+        if (errorCode != ErrorCode::NO_ERROR) {
+            return errorCode;
+        }
+    }
+    std::vector<Faceprint> faceprints;
+    errorCode = tfSdk.getFaceFeatureVectors(facechips, faceprints);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+
+    auto getArea = [](const FaceBoxAndLandmarks &face) {
+        return (face.bottomRight.x - face.topLeft.x) * (face.bottomRight.y - face.topLeft.y);
+    };
+    const auto largest = std::max_element(faces.begin(), faces.end(),
+                                          [&](const FaceBoxAndLandmarks &a,
+                                              const FaceBoxAndLandmarks &b) {
+                                              return getArea(a) < getArea(b);
+                                          }) -
+                         faces.begin();
+    faceprint = faceprints[largest];
+    return ErrorCode::NO_ERROR;
+}
+
+// Chooses the lowest threshold at which at most targetFmr of the impostor pairs match, a pair
+// matching when its similarity is above the threshold. The pairs where a face was missed never
+// match, so a missed face counts against the FNMR. Infinities and denormals are avoided, -Ofast
+// assumes finite math and flushes denormals to zero.
+void computeErrorRates(const ComparisonPairs &pairs, const std::vector<bool> &hasFaceprint,
+                       const std::vector<Faceprint> &faceprints, float targetFmr,
+                       ConfigurationResult &result) {
+    const float noMatch = std::numeric_limits<float>::lowest();
+    auto getScore = [&](const std::pair<size_t, size_t> &pair) {
+        if (!hasFaceprint[pair.first] || !hasFaceprint[pair.second]) {
+            return noMatch;
+        }
+        float probability = 0.f;
+        float similarity = 0.f;
+        if (SDK::getSimilarity(faceprints[pair.first], faceprints[pair.second], probability,
+                               similarity) != ErrorCode::NO_ERROR) {
+            return noMatch;
+        }
+        return similarity;
+    };
+
+    std::vector<float> impostorScores;
+    impostorScores.reserve(pairs.impostor.size());
+    for (const auto &pair : pairs.impostor) {
+        impostorScores.push_back(getScore(pair));
+    }
+    std::sort(impostorScores.begin(), impostorScores.end(), std::greater<float>());
+
+    const auto numFalseMatches = static_cast<size_t>(targetFmr * impostorScores.size());
+    result.threshold = numFalseMatches < impostorScores.size() ? impostorScores[numFalseMatches]
+                                                               : noMatch;
+
+    size_t numMatches = 0;
+    for (auto score : impostorScores) {
+        numMatches += score > result.threshold;
+    }
+    result.fmr = static_cast<float>(numMatches) / impostorScores.size();
+
+    size_t numNonMatches = 0;
+    for (const auto &pair : pairs.genuine) {
+        numNonMatches += !(getScore(pair) > result.threshold);
+    }
+    result.fnmr = static_cast<float>(numNonMatches) / pairs.genuine.size();
+}
+
+bool exploreConfiguration(const Benchmarks::SDKFactory &sdkFactory,
+                          const ConfigurationOptions &options, const ExplorerOptions &explorer,
+                          const std::vector<LabeledImage> &images, const ComparisonPairs &pairs,
+                          ConfigurationResult &result,
+                          Benchmarks::ObservationList &observations) {
+    result.options = options;
+    result.name = getConfigurationName(options, explorer.detectObjects);
+    std::cout << "Exploring " << result.name << std::endl;
+
+    auto tfSdk = sdkFactory.createSDK(options);
+    TFImage img;
+    bool found = false;
+    Faceprint faceprint;
+    for (unsigned int i = 0; i < explorer.numWarmup; ++i) {
+        const auto &path = images[i % images.size()].path;
+        if (tfSdk.preprocessImage(path, img) != ErrorCode::NO_ERROR ||
+            processImage(tfSdk, img, explorer.detectObjects, found, faceprint) !=
+                ErrorCode::NO_ERROR) {
+            std::cout << "Error: unable to process " << path << std::endl;
+            return false;
+        }
+    }
+
+    // Decoding does not depend on the configuration, so only the chain after it is timed
+    std::vector<float> times;
+    times.reserve(images.size());
+    std::vector<bool> hasFaceprint(images.size());
+    std::vector<Faceprint> faceprints(images.size());
+    size_t numFound = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (tfSdk.preprocessImage(images[i].path, img) != ErrorCode::NO_ERROR) {
+            std::cout << "Error: could not load the image " << images[i].path << std::endl;
+            return false;
+        }
+        auto stopwatch = preciseStopwatch();
+        auto errorCode =
+            processImage(tfSdk, img, explorer.detectObjects, found, faceprints[i]);
+        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+        if (errorCode != ErrorCode::NO_ERROR) {
+            std::cout << "Error: unable to process " << images[i].path << std::endl;
+            return false;
+        }
+        hasFaceprint[i] = found;
+        numFound += found;
+    }
+
+    auto parameters = Benchmarks::Parameters{false, 0, 1, 0, 1, {}, {}, {0, true}, {}, {}};
+    parameters.numIterations = static_cast<unsigned int>(times.size());
+    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
+                              result.name, parameters, times, Benchmarks::MemoryProfile{});
+
+    result.meanTime = observations.back().getTimeResult().mean;
+    result.imagesPerSecond = result.meanTime > 0.f ? 1000.f / result.meanTime : 0.f;
+    result.recall = static_cast<float>(numFound) / images.size();
+    computeErrorRates(pairs, hasFaceprint, faceprints, explorer.targetFmr, result);
+    result.isParetoOptimal = false;
+    return true;
+}
+
+// A configuration is Pareto optimal when no other one is at least as fast, with at least the same
+// recall and at most the same FNMR, while being better at one of them
+void findParetoFront(std::vector<ConfigurationResult> &results) {
+    for (auto &result : results) {
+        result.isParetoOptimal = std::none_of(
+            results.begin(), results.end(), [&](const ConfigurationResult &other) {
+                const bool isAsGood = other.imagesPerSecond >= result.imagesPerSecond &&
+                                      other.recall >= result.recall &&
+                                      other.fnmr <= result.fnmr;
+                const bool isBetter = other.imagesPerSecond > result.imagesPerSecond ||
+                                      other.recall > result.recall || other.fnmr < result.fnmr;
+                return isAsGood && isBetter;
+            });
+    }
+}
+
+void printResult(const ConfigurationResult &result) {
+    std::cout << std::fixed << std::setprecision(2) << (result.isParetoOptimal ? "* " : "  ")
+              << result.name << ": " << result.imagesPerSecond << " images/s ("
+              << result.meanTime << " ms) | recall " << result.recall * 100.f << "% | FNMR "
+              << result.fnmr * 100.f << "% at FMR " << std::setprecision(4) << result.fmr * 100.f
+              << "% (threshold " << result.threshold << ")" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+void writeResults(const std::string &path, const std::vector<ConfigurationResult> &results) {
+    std::ofstream file{path};
+    file << "Face Detection Model, Face Detection Filter, Smallest Face Height, "
+         << "Face Recognition Model, Vector Compression, Object Detection Model, "
+         << "Images per Second, Mean Time (ms), Detection Recall, Threshold, FMR, FNMR, "
+         << "Pareto Optimal\n";
+    for (const auto &result : results) {
+        const auto &options = result.options;
+        file << getName(fdModelNames, options.fdModel) << ","
+             << getName(fdFilterNames, options.fdFilter) << "," << options.smallestFaceHeight
+             << "," << getName(frModelNames, options.frModel) << ","
+             << getName(compressionNames, options.frVectorCompression) << ","
+             << getName(objModelNames, options.objModel) << "," << result.imagesPerSecond << ","
+             << result.meanTime << "," << result.recall << "," << result.threshold << ","
+             << result.fmr << "," << result.fnmr << "," << (result.isParetoOptimal ? 1 : 0)
+             << "\n";
+    }
+}
+
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program
+              << " --dataset DIR [--fd-models LIST] [--fd-filters LIST] [--face-heights LIST]"
+                 " [--fr-models LIST] [--vector-compression LIST] [--objects]"
+                 " [--obj-models LIST] [--fmr RATE] [--impostor-pairs N] [--warmup N]"
+              << std::endl;
+    std::cout << "  --dataset DIR  directory with a directory of images per identity, every image "
+                 "holding one face of its identity"
+              << std::endl;
+    std::cout << "  --fd-models LIST  comma separated face detection models (default FAST,ACCURATE)"
+              << std::endl;
+    std::cout << "  --fd-filters LIST  face detection filters "
+                 "(default BALANCED,HIGH_RECALL,HIGH_PRECISION)"
+              << std::endl;
+    std::cout << "  --face-heights LIST  smallest face heights in pixels (default 20,40,80)"
+              << std::endl;
+    std::cout << "  --fr-models LIST  face recognition models "
+                 "(default LITE_V2,LITE_V3,TFV5_2,TFV6,TFV7)"
+              << std::endl;
+    std::cout << "  --vector-compression LIST  vector compression settings (default off,on)"
+              << std::endl;
+    std::cout << "  --objects  also time detectObjects on every image and sweep the object "
+                 "detection models"
+              << std::endl;
+    std::cout << "  --obj-models LIST  object detection models of --objects "
+                 "(default FAST,ACCURATE)"
+              << std::endl;
+    std::cout << "  --fmr RATE  false match rate the threshold is chosen for (default 0.001)"
+              << std::endl;
+    std::cout << "  --impostor-pairs N  impostor pairs compared, sampled when there are more "
+                 "(default 100000)"
+              << std::endl;
+    std::cout << "  --warmup N  images processed before timing every configuration (default 10)"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    ExplorerOptions explorer{"",
+                             {FaceDetectionModel::FAST, FaceDetectionModel::ACCURATE},
+                             {FaceDetectionFilter::BALANCED, FaceDetectionFilter::HIGH_RECALL,
+                              FaceDetectionFilter::HIGH_PRECISION},
+                             {20, 40, 80},
+                             {FacialRecognitionModel::LITE_V2, FacialRecognitionModel::LITE_V3,
+                              FacialRecognitionModel::TFV5_2, FacialRecognitionModel::TFV6,
+                              FacialRecognitionModel::TFV7},
+                             {false, true},
+                             false,
+                             {ObjectDetectionModel::FAST, ObjectDetectionModel::ACCURATE},
+                             0.001f,
+                             100000,
+                             10};
+    for (int i = 1; i < argc; ++i) {
+        bool isValid = true;
+        if (std::strcmp(argv[i], "--dataset") == 0 && i + 1 < argc) {
+            explorer.datasetPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--fd-models") == 0 && i + 1 < argc) {
+            isValid = parseList(argv[++i], fdModelNames, explorer.fdModels);
+        } else if (std::strcmp(argv[i], "--fd-filters") == 0 && i + 1 < argc) {
+            isValid = parseList(argv[++i], fdFilterNames, explorer.fdFilters);
+        } else if (std::strcmp(argv[i], "--face-heights") == 0 && i + 1 < argc) {
+            isValid = parseList(argv[++i], explorer.smallestFaceHeights);
+        } else if (std::strcmp(argv[i], "--fr-models") == 0 && i + 1 < argc) {
+            isValid = parseList(argv[++i], frModelNames, explorer.frModels);
+        } else if (std::strcmp(argv[i], "--vector-compression") == 0 && i + 1 < argc) {
+            isValid = parseList(argv[++i], compressionNames, explorer.frVectorCompressions);
+        } else if (std::strcmp(argv[i], "--objects") == 0) {
+            explorer.detectObjects = true;
+        } else if (std::strcmp(argv[i], "--obj-models") == 0 && i + 1 < argc) {
+            isValid = parseList(argv[++i], objModelNames, explorer.objModels);
+        } else if (std::strcmp(argv[i], "--fmr") == 0 && i + 1 < argc) {
+            explorer.targetFmr = std::stof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--impostor-pairs") == 0 && i + 1 < argc) {
+            explorer.maxImpostorPairs = std::stoull(argv[++i]);
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            explorer.numWarmup = std::stoul(argv[++i]);
+        } else {
+            isValid = false;
+        }
+        if (!isValid) {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (explorer.datasetPath.empty()) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<LabeledImage> images;
+    if (!findLabeledImages(explorer.datasetPath, images) || images.empty()) {
+        std::cout << "Error: no labeled images found in " << explorer.datasetPath << std::endl;
+        return -1;
+    }
+    const auto pairs = getComparisonPairs(images, explorer.maxImpostorPairs);
+    if (pairs.genuine.empty() || pairs.impostor.empty()) {
+        std::cout << "Error: the dataset needs an identity with several images and at least two "
+                     "identities"
+                  << std::endl;
+        return -1;
+    }
+    std::cout << images.size() << " images, " << pairs.genuine.size() << " genuine pairs, "
+              << pairs.impostor.size() << " impostor pairs" << std::endl;
+
+    auto gpuOptions = GPUOptions(false);
+    auto sdkFactory = Benchmarks::SDKFactory(gpuOptions);
+
+    // The object detection model only matters when the objects are detected
+    if (!explorer.detectObjects) {
+        explorer.objModels = {ObjectDetectionModel::FAST};
+    }
+    std::vector<ConfigurationOptions> configurations;
+    for (auto fdModel : explorer.fdModels) {
+        for (auto fdFilter : explorer.fdFilters) {
+            for (auto smallestFaceHeight : explorer.smallestFaceHeights) {
+                for (auto frModel : explorer.frModels) {
+                    for (auto frVectorCompression : explorer.frVectorCompressions) {
+                        for (auto objModel : explorer.objModels) {
+                            auto options = sdkFactory.createBasicConfiguration();
+                            options.fdModel = fdModel;
+                            options.fdFilter = fdFilter;
+                            options.smallestFaceHeight = smallestFaceHeight;
+                            options.frModel = frModel;
+                            options.frVectorCompression = frVectorCompression;
+                            options.objModel = objModel;
+                            options.initializeModule.faceDetector = true;
+                            options.initializeModule.faceRecognizer = true;
+                            options.initializeModule.objectDetector = explorer.detectObjects;
+                            configurations.push_back(options);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "Exploring " << configurations.size() << " configurations" << std::endl;
+
+    auto observations = Benchmarks::ObservationList();
+    std::vector<ConfigurationResult> results(configurations.size());
+    for (size_t i = 0; i < configurations.size(); ++i) {
+        if (!exploreConfiguration(sdkFactory, configurations[i], explorer, images, pairs,
+                                  results[i], observations)) {
+            return -1;
+        }
+    }
+
+    findParetoFront(results);
+    std::sort(results.begin(), results.end(),
+              [](const ConfigurationResult &a, const ConfigurationResult &b) {
+                  return a.imagesPerSecond > b.imagesPerSecond;
+              });
+    std::cout << "Configurations from the fastest, the Pareto optimal ones marked with *"
+              << std::endl;
+    for (const auto &result : results) {
+        printResult(result);
+    }
+    writeResults("configurations.csv", results);
+
+    auto csvWriter = Benchmarks::ObservationCSVWriter(
+        "benchmarks.csv", Benchmarks::HostInfo::detect(observations.front().getVersion()));
+    csvWriter.write(observations);
+
+    return 0;
+}
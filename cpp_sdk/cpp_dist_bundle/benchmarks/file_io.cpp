@@ -0,0 +1,20 @@
+#include "file_io.h"
+
+#include <fstream>
+
+namespace Trueface {
+namespace Benchmarks {
+
+bool readFile(const std::string &path, std::vector<uint8_t> &buffer) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    buffer.resize(size);
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(buffer.data()), size));
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
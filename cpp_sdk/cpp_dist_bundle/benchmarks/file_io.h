@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Reads the whole file at path into buffer, such as an encoded image. Returns false on error.
+bool readFile(const std::string &path, std::vector<uint8_t> &buffer);
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,156 @@
+#include "fixture.h"
+#include "memory_high_water_mark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+Fixture::Fixture(const SDKFactory &sdkFactory, bool cacheSdks)
+    : m_sdkFactory{sdkFactory}, m_cacheSdks{cacheSdks}, m_numSdksReused{0} {}
+
+const SDKFactory &Fixture::getSDKFactory() const { return m_sdkFactory; }
+
+bool Fixture::isCachingSdks() const { return m_cacheSdks; }
+
+Fixture::SDKKey Fixture::makeSDKKey(const ConfigurationOptions &options) {
+    return SDKKey{static_cast<int>(options.frModel),
+                  static_cast<int>(options.objModel),
+                  static_cast<int>(options.fdModel),
+                  static_cast<int>(options.fdFilter),
+                  options.smallestFaceHeight,
+                  options.modelsPath,
+                  options.frVectorCompression,
+                  options.useGlobalInferenceThreadpool};
+}
+
+SDK &Fixture::getSDK(const ConfigurationOptions &options) {
+    const auto key = makeSDKKey(options);
+    auto it = m_sdks.find(key);
+    if (it != m_sdks.end()) {
+        ++m_numSdksReused;
+        return *it->second;
+    }
+
+    MemoryHighWaterMarkTracker memoryTracker;
+    std::unique_ptr<SDK> tfSdk(new SDK(m_sdkFactory.createSDK(options)));
+    m_sdkLoadMemory[key] = memoryTracker.getDifferenceFromBaseline();
+    return *m_sdks.emplace(key, std::move(tfSdk)).first->second;
+}
+
+float Fixture::getSDKLoadMemory(const ConfigurationOptions &options) const {
+    auto it = m_sdkLoadMemory.find(makeSDKKey(options));
+    return it != m_sdkLoadMemory.end() ? it->second : 0.f;
+}
+
+bool Fixture::getImage(SDK &tfSdk, const std::string &imagePath, TFImage &img) {
+    auto it = m_images.find(imagePath);
+    if (it != m_images.end()) {
+        img = it->second;
+        return true;
+    }
+
+    if (tfSdk.preprocessImage(imagePath, img) != ErrorCode::NO_ERROR) {
+        std::cout << "Error: could not load the image " << imagePath << std::endl;
+        return false;
+    }
+    m_images.emplace(imagePath, img);
+    return true;
+}
+
+bool Fixture::getMosaic(SDK &tfSdk, const std::string &imagePath, unsigned int numFaces,
+                        TFImage &img) {
+    const auto key = std::make_pair(imagePath, numFaces);
+    auto it = m_mosaics.find(key);
+    if (it != m_mosaics.end()) {
+        img = it->second;
+        return true;
+    }
+
+    TFImage tile;
+    if (!getImage(tfSdk, imagePath, tile)) {
+        return false;
+    }
+
+    constexpr int width = 1920;
+    constexpr int height = 1080;
+    const int numColumns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(numFaces))));
+    const int numRows = (static_cast<int>(numFaces) + numColumns - 1) / numColumns;
+    const int tileWidth = width / numColumns;
+    const int tileHeight = height / numRows;
+
+    // Every copy is scaled to fit its cell with nearest neighbour sampling and centered in it
+    const uint8_t *source = tile->getData();
+    const int sourceWidth = tile->getWidth();
+    const int sourceHeight = tile->getHeight();
+    const float scale = std::min(static_cast<float>(tileWidth) / sourceWidth,
+                                 static_cast<float>(tileHeight) / sourceHeight);
+    const int scaledWidth = static_cast<int>(sourceWidth * scale);
+    const int scaledHeight = static_cast<int>(sourceHeight * scale);
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 3, 128);
+    for (unsigned int face = 0; face < numFaces; ++face) {
+        const int left = (face % numColumns) * tileWidth + (tileWidth - scaledWidth) / 2;
+        const int top = (face / numColumns) * tileHeight + (tileHeight - scaledHeight) / 2;
+        for (int y = 0; y < scaledHeight; ++y) {
+            const int sourceY = std::min(static_cast<int>(y / scale), sourceHeight - 1);
+            for (int x = 0; x < scaledWidth; ++x) {
+                const int sourceX = std::min(static_cast<int>(x / scale), sourceWidth - 1);
+                const uint8_t *sourcePixel =
+                    &source[(static_cast<size_t>(sourceY) * sourceWidth + sourceX) * 3];
+                std::copy(sourcePixel, sourcePixel + 3,
+                          &pixels[(static_cast<size_t>(top + y) * width + left + x) * 3]);
+            }
+        }
+    }
+
+    if (tfSdk.preprocessImage(pixels.data(), width, height, ColorCode::rgb, img) !=
+        ErrorCode::NO_ERROR) {
+        std::cout << "Error: could not create a frame of " << numFaces << " faces" << std::endl;
+        return false;
+    }
+    m_mosaics.emplace(key, img);
+    return true;
+}
+
+bool Fixture::getLargestFace(SDK &tfSdk, const ConfigurationOptions &options,
+                             const std::string &imagePath, FaceInput &face) {
+    const FaceKey key{imagePath, static_cast<int>(options.fdModel),
+                      static_cast<int>(options.fdFilter), options.smallestFaceHeight};
+    auto it = m_faces.find(key);
+    if (it != m_faces.end()) {
+        face = it->second;
+        return true;
+    }
+
+    if (!getImage(tfSdk, imagePath, face.image)) {
+        return false;
+    }
+
+    bool found = false;
+    ErrorCode errorCode = tfSdk.detectLargestFace(face.image, face.faceBoxAndLandmarks, found);
+    if (errorCode != ErrorCode::NO_ERROR || !found) {
+        std::cout << "Unable to detect face in image " << imagePath << std::endl;
+        return false;
+    }
+
+    errorCode = tfSdk.extractAlignedFace(face.image, face.faceBoxAndLandmarks, face.facechip);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        std::cout << "Error: Unable to extract aligned face in image " << imagePath << std::endl;
+        return false;
+    }
+
+    m_faces.emplace(key, face);
+    return true;
+}
+
+unsigned int Fixture::getNumSdksCreated() const { return static_cast<unsigned int>(m_sdks.size()); }
+
+unsigned int Fixture::getNumSdksReused() const { return m_numSdksReused; }
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "sdkfactory.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// An image, its largest face and the aligned chip of that face
+struct FaceInput {
+    TFImage image;
+    FaceBoxAndLandmarks faceBoxAndLandmarks;
+    TFFacechip facechip;
+};
+
+// State shared by the benchmarks of a run, so that the models are loaded and the inputs are
+// prepared once rather than by every benchmark.
+// SDK instances are cached by the configuration options which select and tune the models. The
+// modules to initialize are not part of the key: a module that was not initialized by the first
+// benchmark to use the instance is loaded during the warmup of the next one.
+// The instances stay alive until the end of the run. The memory used to create an instance is
+// recorded, so that every benchmark using it reports it whichever benchmark created it.
+class Fixture {
+public:
+    // Without caching, every benchmark creates its own SDK instance
+    Fixture(const SDKFactory &sdkFactory, bool cacheSdks);
+
+    const SDKFactory &getSDKFactory() const;
+    bool isCachingSdks() const;
+
+    // The cached instance for the options, created on first use
+    SDK &getSDK(const ConfigurationOptions &options);
+    // Growth of the peak resident memory while getSDK created the instance for the options, in MB.
+    // 0 when the instance was not created yet.
+    float getSDKLoadMemory(const ConfigurationOptions &options) const;
+
+    // The image at imagePath, preprocessed once
+    bool getImage(SDK &tfSdk, const std::string &imagePath, TFImage &img);
+    // A 1920x1080 frame with the image tiled numFaces times in a grid, to time the calls which
+    // process every face of a frame. Built once per image and number of faces.
+    bool getMosaic(SDK &tfSdk, const std::string &imagePath, unsigned int numFaces, TFImage &img);
+    // The largest face of the image and its chip, detected and extracted once per face detector
+    // configuration. Prints an error and returns false when no face is found.
+    bool getLargestFace(SDK &tfSdk, const ConfigurationOptions &options,
+                        const std::string &imagePath, FaceInput &face);
+
+    // Number of SDK instances created and of benchmarks which reused one of them
+    unsigned int getNumSdksCreated() const;
+    unsigned int getNumSdksReused() const;
+
+private:
+    using SDKKey = std::tuple<int, int, int, int, unsigned int, std::string, bool, bool>;
+    using FaceKey = std::tuple<std::string, int, int, unsigned int>;
+
+    static SDKKey makeSDKKey(const ConfigurationOptions &options);
+
+    const SDKFactory &m_sdkFactory;
+    bool m_cacheSdks;
+    std::map<SDKKey, std::unique_ptr<SDK>> m_sdks;
+    std::map<SDKKey, float> m_sdkLoadMemory;
+    std::map<std::string, TFImage> m_images;
+    std::map<std::pair<std::string, unsigned int>, TFImage> m_mosaics;
+    std::map<FaceKey, FaceInput> m_faces;
+    unsigned int m_numSdksReused;
+};
+
+} // namespace Benchmarks
+} // namespace Trueface
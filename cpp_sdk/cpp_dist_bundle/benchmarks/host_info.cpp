@@ -0,0 +1,107 @@
+#include "host_info.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#endif
+
+using namespace Trueface::Benchmarks;
+
+namespace {
+
+const std::vector<std::string> relevantIsaFlags{
+    // x86
+    "sse4_1", "sse4_2", "avx", "avx2", "fma", "f16c", "avx512f", "avx512bw", "avx512vl",
+    "avx512_vnni", "avx512_bf16", "avx_vnni", "amx_tile",
+    // arm
+    "asimd", "asimddp", "asimdhp", "sve", "sve2", "bf16", "i8mm"};
+
+std::string trim(const std::string &s) {
+    const auto first = s.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return "";
+    }
+    const auto last = s.find_last_not_of(" \t");
+    return s.substr(first, last - first + 1);
+}
+
+std::string filterIsaFlags(const std::string &flags) {
+    std::istringstream in{flags};
+    std::vector<std::string> present;
+    std::string flag;
+    while (in >> flag) {
+        if (std::find(relevantIsaFlags.begin(), relevantIsaFlags.end(), flag) !=
+            relevantIsaFlags.end()) {
+            present.push_back(flag);
+        }
+    }
+    std::sort(present.begin(), present.end());
+
+    std::string result;
+    for (const auto &f : present) {
+        result += (result.empty() ? "" : " ") + f;
+    }
+    return result;
+}
+
+std::string fnv1a(const std::string &s) {
+    uint64_t hash = 14695981039346656037ull;
+    for (auto c : s) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return out.str();
+}
+
+std::string utcTimestamp() {
+    std::time_t now = std::time(nullptr);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return buffer;
+}
+
+} // namespace
+
+HostInfo HostInfo::detect(const std::string &sdkVersion) {
+    HostInfo info{"unknown", "", std::thread::hardware_concurrency(), sdkVersion, "",
+                  utcTimestamp()};
+
+#ifdef __APPLE__
+    char brand[256];
+    size_t size = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) == 0) {
+        info.cpuModel = brand;
+    }
+#else
+    // LINUX ONLY: the fields of /proc/cpuinfo differ between x86 and arm
+    std::ifstream cpuinfo{"/proc/cpuinfo"};
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        const auto colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        const auto key = trim(line.substr(0, colon));
+        const auto value = trim(line.substr(colon + 1));
+        if ((key == "model name" || key == "Model") && info.cpuModel == "unknown") {
+            info.cpuModel = value;
+        } else if ((key == "flags" || key == "Features") && info.isaFlags.empty()) {
+            info.isaFlags = filterIsaFlags(value);
+        }
+    }
+#endif
+
+    info.fingerprint =
+        fnv1a(info.cpuModel + "|" + info.isaFlags + "|" + std::to_string(info.numCores));
+    return info;
+}
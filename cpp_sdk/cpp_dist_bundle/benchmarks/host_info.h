@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Describes the machine the benchmarks ran on, so that results from different machines are not
+// compared with each other.
+struct HostInfo {
+    std::string cpuModel;
+    // SIMD extensions relevant to inference speed, space separated
+    std::string isaFlags;
+    unsigned int numCores;
+    std::string sdkVersion;
+    // Hash of the CPU model, ISA flags and core count. Identifies the machine, not the SDK.
+    std::string fingerprint;
+    // UTC time at which the host was inspected, in ISO 8601 format
+    std::string timestamp;
+
+    static HostInfo detect(const std::string &sdkVersion);
+};
+
+} // namespace Benchmarks
+} // namespace Trueface
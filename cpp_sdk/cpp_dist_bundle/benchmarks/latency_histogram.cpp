@@ -0,0 +1,77 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+constexpr unsigned int subBucketBits{7};
+constexpr uint64_t subBucketCount{uint64_t{1} << subBucketBits};
+
+unsigned int highestBit(uint64_t value) {
+    unsigned int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+} // namespace
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < subBucketCount) {
+        return static_cast<size_t>(value);
+    }
+
+    // keep the subBucketBits + 1 most significant bits of the value
+    const auto shift = highestBit(value) - subBucketBits;
+    const auto mantissa = value >> shift;
+    return static_cast<size_t>((shift + 1) * subBucketCount + (mantissa - subBucketCount));
+}
+
+uint64_t LatencyHistogram::bucketValue(size_t index) {
+    if (index < subBucketCount) {
+        return index;
+    }
+
+    // middle of the range of values sharing the bucket
+    const auto shift = index / subBucketCount - 1;
+    const auto mantissa = index % subBucketCount + subBucketCount;
+    const auto lowest = mantissa << shift;
+    return lowest + ((uint64_t{1} << shift) >> 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    const auto index = bucketIndex(value);
+    if (index >= m_counts.size()) {
+        m_counts.resize(index + 1, 0);
+    }
+
+    ++m_counts[index];
+    ++m_count;
+    m_max = std::max(m_max, value);
+}
+
+uint64_t LatencyHistogram::getValueAtPercentile(double percentile) const {
+    if (m_count == 0) {
+        return 0;
+    }
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    auto target = static_cast<uint64_t>(std::ceil(percentile / 100.0 * m_count));
+    target = std::max<uint64_t>(target, 1);
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+        cumulative += m_counts[i];
+        if (cumulative >= target) {
+            return std::min(bucketValue(i), m_max);
+        }
+    }
+
+    return m_max;
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Log-bucketed latency histogram in the style of HdrHistogram.
+// Values are bucketed by their power of two, and each power of two is split into 128 linear
+// sub-buckets, which bounds the relative error of the reported percentiles to 1/128 while keeping
+// the memory independent of the number of recorded values.
+class LatencyHistogram {
+public:
+    void record(uint64_t value);
+
+    uint64_t getCount() const { return m_count; }
+    uint64_t getMax() const { return m_max; }
+    // percentile in the range [0, 100]
+    uint64_t getValueAtPercentile(double percentile) const;
+
+private:
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketValue(size_t index);
+
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count = 0;
+    uint64_t m_max = 0;
+};
+
+} // namespace Benchmarks
+} // namespace Trueface
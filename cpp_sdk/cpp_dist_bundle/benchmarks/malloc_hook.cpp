@@ -0,0 +1,121 @@
+// Counts the calls to the allocator of the whole process, including the ones made by the SDK and
+// its dependencies. Either link it into run_benchmarks with -DBENCHMARK_MALLOC_HOOK=ON, or build
+// the malloc_hook library and preload it:
+// > LD_PRELOAD=./libmalloc_hook.so ./run_benchmarks
+// The hook forwards to the glibc allocator, so it is only available on Linux with glibc.
+
+#include "allocation_counters.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void *__libc_valloc(size_t size);
+void *__libc_pvalloc(size_t size);
+void __libc_free(void *ptr);
+}
+
+namespace {
+
+// Constant initialized, so they can be used before the static constructors run
+std::atomic<uint64_t> numAllocations{0};
+std::atomic<uint64_t> numFrees{0};
+std::atomic<uint64_t> bytesAllocated{0};
+std::atomic<int64_t> liveBytes{0};
+
+void *countAllocation(void *ptr) {
+    if (ptr) {
+        const auto size = malloc_usable_size(ptr);
+        numAllocations.fetch_add(1, std::memory_order_relaxed);
+        bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+        liveBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return ptr;
+}
+
+void countFree(size_t size) {
+    numFrees.fetch_add(1, std::memory_order_relaxed);
+    liveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+} // namespace
+
+extern "C" {
+
+void *malloc(size_t size) { return countAllocation(__libc_malloc(size)); }
+
+void *calloc(size_t count, size_t size) { return countAllocation(__libc_calloc(count, size)); }
+
+void *realloc(void *ptr, size_t size) {
+    const auto previousSize = ptr ? malloc_usable_size(ptr) : 0;
+    void *result = __libc_realloc(ptr, size);
+    if (!result && size) {
+        // the original allocation is left untouched
+        return result;
+    }
+    if (ptr) {
+        countFree(previousSize);
+    }
+    return countAllocation(result);
+}
+
+void *reallocarray(void *ptr, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(ptr, count * size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    return countAllocation(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return countAllocation(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    if (!alignment || (alignment & (alignment - 1)) || alignment % sizeof(void *)) {
+        return EINVAL;
+    }
+    void *result = countAllocation(__libc_memalign(alignment, size));
+    if (!result && size) {
+        return ENOMEM;
+    }
+    *ptr = result;
+    return 0;
+}
+
+void *valloc(size_t size) { return countAllocation(__libc_valloc(size)); }
+
+void *pvalloc(size_t size) { return countAllocation(__libc_pvalloc(size)); }
+
+void free(void *ptr) {
+    if (ptr) {
+        countFree(malloc_usable_size(ptr));
+    }
+    __libc_free(ptr);
+}
+
+// Read by readAllocationCounters
+void trueface_benchmarks_read_allocation_counters(
+    Trueface::Benchmarks::AllocationCounters *counters) {
+    counters->numAllocations = numAllocations.load(std::memory_order_relaxed);
+    counters->numFrees = numFrees.load(std::memory_order_relaxed);
+    counters->bytesAllocated = bytesAllocated.load(std::memory_order_relaxed);
+    counters->liveBytes = liveBytes.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
+
+#endif
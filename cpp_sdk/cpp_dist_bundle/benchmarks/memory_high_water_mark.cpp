@@ -1,9 +1,21 @@
 #include "memory_high_water_mark.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <future>
+#include <limits>
+#include <string>
 #if !defined(WIN32) && !defined(_WIN32)
+#include <fcntl.h>
 #include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
 #ifdef __APPLE__
+#include <mach/mach.h>
 #include <sys/time.h>
 #endif
 #include <sys/resource.h>
@@ -14,9 +26,72 @@
 
 using namespace Trueface::Benchmarks;
 
-MemoryHighWaterMarkTracker::MemoryHighWaterMarkTracker() {
+namespace {
+// Interval between two samples of the resident memory
+constexpr std::chrono::milliseconds samplingInterval{20};
+
+#if defined(__linux__)
+std::mutex samplerThreadsMutex;
+std::vector<int> samplerThreadIds;
+#endif
+
+#if !defined(WIN32) && !defined(_WIN32) && !defined(__APPLE__)
+// Reads the value of a "Key: value kB" line of a /proc file, in MB
+bool readProcValue(const char *path, const std::string &key, float &value) {
+    std::ifstream in{path};
+    std::string field;
+    while (in >> field) {
+        if (field == key) {
+            in >> value;
+            value /= 1000.f;
+            return true;
+        }
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return false;
+}
+#endif
+} // namespace
+
+MemoryHighWaterMarkTracker::MemoryHighWaterMarkTracker()
+    : m_baseline{0.f}, m_stop{false}, m_peakRss{0.f}, m_peakPss{0.f} {
     resetVmHighWaterMark();
     m_baseline = getVmHighWaterMark();
+    std::promise<void> isRegistered;
+    m_sampler = std::thread{[this, &isRegistered]() {
+#if defined(__linux__)
+        const auto threadId = static_cast<int>(::syscall(SYS_gettid));
+        {
+            std::lock_guard<std::mutex> lock(samplerThreadsMutex);
+            samplerThreadIds.push_back(threadId);
+        }
+#endif
+        isRegistered.set_value();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        do {
+            lock.unlock();
+            sample();
+            lock.lock();
+        } while (!m_stopCondVar.wait_for(lock, samplingInterval, [this] { return m_stop; }));
+
+#if defined(__linux__)
+        std::lock_guard<std::mutex> registryLock(samplerThreadsMutex);
+        samplerThreadIds.erase(
+            std::find(samplerThreadIds.begin(), samplerThreadIds.end(), threadId));
+#endif
+    }};
+    // the perf counters started next must see the sampler to leave it out
+    isRegistered.get_future().wait();
+}
+
+MemoryHighWaterMarkTracker::~MemoryHighWaterMarkTracker() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_stopCondVar.notify_all();
+    m_sampler.join();
 }
 
 void MemoryHighWaterMarkTracker::resetVmHighWaterMark() {
@@ -26,11 +101,11 @@ void MemoryHighWaterMarkTracker::resetVmHighWaterMark() {
     // LINUX ONLY: https://www.kernel.org/doc/html/latest/filesystems/proc.html
     // "To reset the peak resident set size ("high water mark") to the process's current value:"
     // > echo 5 > /proc/PID/clear_refs
+    // The reset is done by the write itself, there is no need to wait for it.
     //
     std::ofstream clear_refs_stream{"/proc/self/clear_refs"};
     clear_refs_stream << "5" << std::endl;
     clear_refs_stream.close();
-    ::sleep(1);
     m_baseline = getVmHighWaterMark();
 #endif
 #endif
@@ -38,6 +113,16 @@ void MemoryHighWaterMarkTracker::resetVmHighWaterMark() {
 
 float MemoryHighWaterMarkTracker::getVmHighWaterMark() const {
 #if !defined(WIN32) && !defined(_WIN32)
+#ifndef __APPLE__
+    //
+    // ru_maxrss also includes the peak of the threads that exited before the last reset, such
+    // as the sampling thread of a previous tracker, so read the high water mark itself.
+    //
+    float highWaterMark = 0.f;
+    if (readProcValue("/proc/self/status", "VmHWM:", highWaterMark)) {
+        return highWaterMark;
+    }
+#endif
     struct rusage usage {};
     if (!getrusage(RUSAGE_SELF, &usage)) {
         //
@@ -56,4 +141,77 @@ float MemoryHighWaterMarkTracker::getDifferenceFromBaseline() const {
     auto current = getVmHighWaterMark();
 
     return m_baseline < current ? current - m_baseline : 0.0f;
-}
\ No newline at end of file
+}
+
+float MemoryHighWaterMarkTracker::getPeakRss() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_peakRss;
+}
+
+float MemoryHighWaterMarkTracker::getPeakPss() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_peakPss;
+}
+
+std::vector<int> MemoryHighWaterMarkTracker::getSamplerThreadIds() {
+#if defined(__linux__)
+    std::lock_guard<std::mutex> lock(samplerThreadsMutex);
+    return samplerThreadIds;
+#else
+    return {};
+#endif
+}
+
+void MemoryHighWaterMarkTracker::sample() {
+    float rss = 0.f;
+    float pss = 0.f;
+#if !defined(WIN32) && !defined(_WIN32) && !defined(__APPLE__)
+    //
+    // smaps_rollup (Linux 4.14+) sums the mappings in the kernel, reading smaps would be too slow.
+    // Read it into a stack buffer, so that the sampling does not show up in the allocation counts.
+    //
+    char buffer[4096];
+    int fd = ::open("/proc/self/smaps_rollup", O_RDONLY);
+    if (fd >= 0) {
+        const auto size = ::read(fd, buffer, sizeof(buffer) - 1);
+        ::close(fd);
+        if (size > 0) {
+            buffer[size] = '\0';
+            const char *line = std::strstr(buffer, "\nRss:");
+            if (line) {
+                rss = std::strtof(line + 5, nullptr) / 1000.f;
+            }
+            line = std::strstr(buffer, "\nPss:");
+            if (line) {
+                pss = std::strtof(line + 5, nullptr) / 1000.f;
+            }
+        }
+    }
+#endif
+    if (rss <= 0.f) {
+        rss = getResidentSetSize();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peakRss = std::max(m_peakRss, rss);
+    m_peakPss = std::max(m_peakPss, pss);
+}
+
+float Trueface::Benchmarks::getResidentSetSize() {
+#if !defined(WIN32) && !defined(_WIN32)
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info),
+                  &count) == KERN_SUCCESS) {
+        return info.resident_size / 1000.f / 1000.f;
+    }
+#else
+    float rss = 0.f;
+    if (readProcValue("/proc/self/status", "VmRSS:", rss)) {
+        return rss;
+    }
+#endif
+#endif
+    return 0.0;
+}
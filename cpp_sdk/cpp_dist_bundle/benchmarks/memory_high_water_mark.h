@@ -1,19 +1,50 @@
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace Trueface {
 namespace Benchmarks {
 
+// Tracks the growth of the peak resident memory from construction, and samples the resident
+// (RSS) and proportional (PSS) set sizes on a background thread.
 class MemoryHighWaterMarkTracker {
 public:
     MemoryHighWaterMarkTracker();
+    ~MemoryHighWaterMarkTracker();
+
+    MemoryHighWaterMarkTracker(const MemoryHighWaterMarkTracker &) = delete;
+    MemoryHighWaterMarkTracker &operator=(const MemoryHighWaterMarkTracker &) = delete;
 
     void resetVmHighWaterMark();
     float getVmHighWaterMark() const;
     float getDifferenceFromBaseline() const;
 
+    // Largest values sampled since construction, in MB. The PSS is only available on Linux.
+    float getPeakRss() const;
+    float getPeakPss() const;
+
+    // Kernel ids of the sampling threads of the trackers alive, so that the perf counters can
+    // leave them out. Empty where not supported.
+    static std::vector<int> getSamplerThreadIds();
+
 private:
+    void sample();
+
     float m_baseline;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_stopCondVar;
+    bool m_stop;
+    float m_peakRss;
+    float m_peakPss;
+    std::thread m_sampler;
 };
 
+// Current resident set size in MB, 0 where not supported
+float getResidentSetSize();
+
 } // namespace Benchmarks
 } // namespace Trueface
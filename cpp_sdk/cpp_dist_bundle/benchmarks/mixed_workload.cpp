@@ -0,0 +1,285 @@
+#include "mixed_workload.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t numProbes{1000};
+
+struct CallLog {
+    // latency of every call from its scheduled start in ns
+    std::vector<float> times;
+    // calls per second achieved over the phase
+    float rate;
+};
+
+struct PhaseResult {
+    CallLog searches;
+    CallLog enrollments;
+    CallLog removals;
+};
+
+// Starts a call every 1 / rate seconds until the deadline. A call due while the previous one is
+// still running starts as soon as it returns, so a slow call delays the calls after it rather than
+// being skipped. call(i, scheduled) times itself from its scheduled start, so that the wait behind
+// a slow call counts in the latency of the calls it delays, and returns false on error or when it
+// has nothing left to do.
+bool callAtRate(float rate, Clock::time_point deadline,
+                const std::function<bool(size_t, Clock::time_point)> &call, CallLog &log) {
+    const auto interval =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    const auto start = Clock::now();
+    auto next = start;
+    size_t numCalls = 0;
+    bool isOk = true;
+    while (next < deadline && Clock::now() < deadline) {
+        std::this_thread::sleep_until(next);
+        if (!call(numCalls, next)) {
+            isOk = false;
+            break;
+        }
+        ++numCalls;
+        next += interval;
+    }
+    const float elapsed = std::chrono::duration<float>(Clock::now() - start).count();
+    log.rate = elapsed > 0.f ? numCalls / elapsed : 0.f;
+    return isOk;
+}
+
+// in ns, the unit of the call logs
+float sinceScheduled(Clock::time_point scheduled) {
+    return std::chrono::duration<float, std::nano>(Clock::now() - scheduled).count();
+}
+
+// Searches the collection at the search rate for the duration, and when withWrites is set
+// enrolls and removes templates from two more threads at the same time. Returns false on error.
+bool runPhase(SDK &sdk, const MixedWorkloadOptions &options, const TemplateGenerator &generator,
+              const std::vector<Faceprint> &probes, const std::vector<std::string> &UUIDs,
+              bool withWrites, uint64_t &nextIdentity, size_t &nextRemoval, PhaseResult &result) {
+    const auto deadline =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                           std::chrono::duration<float>(options.duration));
+    std::atomic<bool> isFailed{false};
+    std::vector<std::thread> threads;
+
+    threads.emplace_back([&]() {
+        Candidate candidate;
+        bool found;
+        const bool isOk = callAtRate(
+            options.searchesPerSecond, deadline,
+            [&](size_t i, Clock::time_point scheduled) {
+                auto ret = sdk.identifyTopCandidate(probes[i % probes.size()], candidate, found);
+                result.searches.times.emplace_back(sinceScheduled(scheduled));
+                return ret == ErrorCode::NO_ERROR;
+            },
+            result.searches);
+        if (!isOk) {
+            std::cout << "Unable to search the collection" << std::endl;
+            isFailed = true;
+        }
+    });
+
+    if (withWrites && options.enrollmentsPerSecond > 0.f) {
+        threads.emplace_back([&]() {
+            std::vector<float> center;
+            Faceprint faceprint;
+            const bool isOk = callAtRate(
+                options.enrollmentsPerSecond, deadline,
+                [&](size_t, Clock::time_point scheduled) {
+                    const uint64_t identity = nextIdentity++;
+                    generator.generateIdentity(identity, center);
+                    generator.generateTemplate(center, identity, 0, faceprint);
+                    std::string UUID;
+                    auto ret = sdk.enrollFaceprint(
+                        faceprint, TemplateGenerator::getIdentityName(identity), UUID);
+                    result.enrollments.times.emplace_back(sinceScheduled(scheduled));
+                    return ret == ErrorCode::NO_ERROR;
+                },
+                result.enrollments);
+            if (!isOk) {
+                std::cout << "Unable to enroll template" << std::endl;
+                isFailed = true;
+            }
+        });
+    }
+
+    if (withWrites && options.removalsPerSecond > 0.f) {
+        threads.emplace_back([&]() {
+            // the templates enrolled before the benchmark are removed, oldest first
+            callAtRate(
+                options.removalsPerSecond, deadline,
+                [&](size_t, Clock::time_point scheduled) {
+                    if (nextRemoval >= UUIDs.size()) {
+                        return false;
+                    }
+                    auto ret = sdk.removeByUUID(UUIDs[nextRemoval++]);
+                    result.removals.times.emplace_back(sinceScheduled(scheduled));
+                    if (ret != ErrorCode::NO_ERROR) {
+                        std::cout << "Unable to remove template" << std::endl;
+                        isFailed = true;
+                        return false;
+                    }
+                    return true;
+                },
+                result.removals);
+            if (nextRemoval >= UUIDs.size()) {
+                std::cout << "Every enrolled template was removed, the removals stopped early"
+                          << std::endl;
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return !isFailed;
+}
+
+std::string formatRate(float rate) {
+    std::ostringstream stream;
+    stream << rate;
+    return stream.str();
+}
+
+// Returns false when there were no calls to observe
+bool addObservation(const SDKFactory &sdkFactory, const std::string &subType,
+                    const CallLog &log, ObservationList &observations) {
+    if (log.times.empty()) {
+        return false;
+    }
+    auto params = Parameters{false, 0, 1, static_cast<unsigned int>(log.times.size()), 1, {}, {},
+                             {0, true}, {}, {}};
+    observations.emplace_back(
+        SDK::getVersion(), sdkFactory.isGpuEnabled(), "1 to N mixed workload", subType, params,
+        log.times, MemoryProfile{},
+        ThroughputResult{ConcurrencyMode::SINGLE_THREAD, 1, log.rate, 1.f, {}});
+    return true;
+}
+
+} // namespace
+
+void runMixedWorkloadBenchmark(const SDKFactory &sdkFactory, const MixedWorkloadOptions &options,
+                               ObservationList &observations) {
+    if (options.collectionSize == 0 || options.searchesPerSecond <= 0.f ||
+        options.duration <= 0.f) {
+        std::cout << "The collection size, the search rate and the duration must be positive"
+                  << std::endl;
+        return;
+    }
+
+    auto sdkOptions = sdkFactory.createBasicConfiguration();
+    sdkOptions.frModel = FacialRecognitionModel::TFV7;
+    sdkOptions.dbms = DatabaseManagementSystem::NONE;
+    sdkOptions.frVectorCompression = false;
+    auto sdk = sdkFactory.createSDK(sdkOptions);
+
+    // A real template gives the size and the metadata of the generated ones
+    TFImage img;
+    Faceprint prototype;
+    bool foundFace = false;
+    if (sdk.preprocessImage("../images/headshot.jpg", img) != ErrorCode::NO_ERROR ||
+        sdk.getLargestFaceFeatureVector(img, prototype, foundFace) != ErrorCode::NO_ERROR ||
+        !foundFace) {
+        std::cout << "Unable to detect face and extract features" << std::endl;
+        return;
+    }
+
+    if (sdk.createLoadCollection("mixed_workload") != ErrorCode::NO_ERROR) {
+        std::cout << "Error creating collection" << std::endl;
+        return;
+    }
+
+    std::cout << "Populating collection with " << options.collectionSize << " templates"
+              << std::endl;
+    TemplateGenerator generator{prototype, options.generator};
+    std::vector<std::string> UUIDs;
+    UUIDs.reserve(options.collectionSize);
+    std::vector<float> center;
+    Faceprint faceprint;
+    for (uint64_t identity = 0; identity < options.collectionSize; ++identity) {
+        generator.generateIdentity(identity, center);
+        generator.generateTemplate(center, identity, 0, faceprint);
+        std::string UUID;
+        if (sdk.enrollFaceprint(faceprint, TemplateGenerator::getIdentityName(identity), UUID) !=
+            ErrorCode::NO_ERROR) {
+            std::cout << "Unable to enroll template" << std::endl;
+            return;
+        }
+        UUIDs.push_back(std::move(UUID));
+    }
+
+    // Mated probes of random enrolled identities. The removals may remove some of them, which
+    // only turns them into non-mated probes.
+    std::vector<Faceprint> probes(numProbes);
+    std::mt19937_64 engine{options.generator.seed};
+    std::uniform_int_distribution<uint64_t> identities{0, options.collectionSize - 1};
+    for (auto &probe : probes) {
+        const uint64_t identity = identities(engine);
+        generator.generateIdentity(identity, center);
+        generator.generateTemplate(center, identity, 1, probe);
+    }
+
+    uint64_t nextIdentity = options.collectionSize;
+    size_t nextRemoval = 0;
+    const std::string collection = "(" + std::to_string(options.collectionSize) + ") ";
+
+    std::cout << "Searching at " << options.searchesPerSecond << " searches/s for "
+              << options.duration << " s" << std::endl;
+    PhaseResult searchOnly{};
+    if (!runPhase(sdk, options, generator, probes, UUIDs, false, nextIdentity, nextRemoval,
+                  searchOnly)) {
+        return;
+    }
+    if (!addObservation(sdkFactory, collection + "search, no writes", searchOnly.searches,
+                        observations)) {
+        std::cout << "No search was run, increase the duration or the search rate" << std::endl;
+        return;
+    }
+    const float baselineP99 = observations.back().getTimeResult().p99;
+
+    std::cout << "Searching while enrolling at " << options.enrollmentsPerSecond
+              << " templates/s and removing at " << options.removalsPerSecond
+              << " templates/s for " << options.duration << " s" << std::endl;
+    PhaseResult mixed{};
+    if (!runPhase(sdk, options, generator, probes, UUIDs, true, nextIdentity, nextRemoval,
+                  mixed)) {
+        return;
+    }
+    const std::string writes = formatRate(options.enrollmentsPerSecond) + " enrollments/s, " +
+                               formatRate(options.removalsPerSecond) + " removals/s";
+    if (!addObservation(sdkFactory, collection + "search, " + writes, mixed.searches,
+                        observations)) {
+        std::cout << "No search was run, increase the duration or the search rate" << std::endl;
+        return;
+    }
+    const float mixedP99 = observations.back().getTimeResult().p99;
+    addObservation(sdkFactory, collection + "enrollment, " + writes, mixed.enrollments,
+                   observations);
+    addObservation(sdkFactory, collection + "removal, " + writes, mixed.removals, observations);
+
+    std::cout << "Search p99 latency: " << baselineP99 << " ms without writes, " << mixedP99
+              << " ms with writes in flight (" << (mixedP99 / baselineP99 - 1.f) * 100.f
+              << "%)" << std::endl;
+    std::cout << "Achieved " << searchOnly.searches.rate << " and " << mixed.searches.rate
+              << " searches/s, " << mixed.enrollments.rate << " enrollments/s, "
+              << mixed.removals.rate << " removals/s" << std::endl;
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "observation.h"
+#include "sdkfactory.h"
+#include "template_generator.h"
+
+#include <cstddef>
+
+namespace Trueface {
+namespace Benchmarks {
+
+struct MixedWorkloadOptions {
+    size_t collectionSize;
+    // Target rates of the searches, enrollments and removals, in calls per second. A rate of 0
+    // disables the calls.
+    float searchesPerSecond;
+    float enrollmentsPerSecond;
+    float removalsPerSecond;
+    // Duration of the search only phase and of the mixed phase, in seconds
+    float duration;
+    TemplateGeneratorOptions generator;
+};
+
+// Measures whether enrollments and removals stall live identification. A collection of distinct
+// synthetic templates is searched at a fixed rate, first alone and then while other threads enroll
+// new templates and remove enrolled ones at their own rates, all sharing one SDK. The search
+// latency of both phases and the write throughput achieved are reported.
+void runMixedWorkloadBenchmark(const SDKFactory &sdkFactory, const MixedWorkloadOptions &options,
+                               ObservationList &observations);
+
+} // namespace Benchmarks
+} // namespace Trueface
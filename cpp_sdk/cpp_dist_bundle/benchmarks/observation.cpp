@@ -1,6 +1,8 @@
 #include "observation.h"
+#include "statistics.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -11,6 +13,32 @@
 namespace Trueface {
 namespace Benchmarks {
 
+namespace {
+const char *toString(ConcurrencyMode mode) {
+    switch (mode) {
+    case ConcurrencyMode::SHARED_SDK:
+        return "shared SDK";
+    case ConcurrencyMode::SDK_PER_THREAD:
+        return "SDK per thread";
+    default:
+        return "single thread";
+    }
+}
+
+const char *toString(StopReason reason) {
+    switch (reason) {
+    case StopReason::CONFIDENCE_TARGET:
+        return "confidence target";
+    case StopReason::TIME_BUDGET:
+        return "time budget";
+    case StopReason::MAX_ITERATIONS:
+        return "max iterations";
+    default:
+        return "fixed count";
+    }
+}
+} // namespace
+
 void Observation::emitToUser() {
     // screen output for reporting progress to user
     std::cout << "Average time " << m_benchmarkName;
@@ -20,92 +48,365 @@ void Observation::emitToUser() {
 
     auto precision{std::cout.precision()};
     std::cout << ": " << std::fixed << std::setprecision(3) << m_time.mean << " ms"
-              << std::defaultfloat << std::setprecision(precision);
+              << " | p99 = " << m_time.p99 << " ms" << std::defaultfloat
+              << std::setprecision(precision);
 
     if (m_params.batchSize > 1) {
         std::cout << " | batch size = " << m_params.batchSize;
     }
 
-    std::cout << " | " << m_params.numIterations << " iterations " << std::endl;
+    if (m_params.inferenceThreading.numThreads) {
+        std::cout << " | " << m_params.inferenceThreading.numThreads << " inference threads";
+    }
+
+    if (m_throughput.mode != ConcurrencyMode::SINGLE_THREAD) {
+        std::cout << " | " << m_throughput.numThreads << " threads (" << toString(m_throughput.mode)
+                  << ") | " << std::fixed << std::setprecision(1)
+                  << m_throughput.inferencesPerSecond << " inferences/s | "
+                  << m_throughput.scalingEfficiency * 100.f << "% scaling efficiency"
+                  << std::defaultfloat << std::setprecision(precision);
+    }
+
+    if (m_params.inputSize.megapixels > 0.f && m_time.mean > 0.f) {
+        std::cout << " | " << std::fixed << std::setprecision(1)
+                  << m_params.inputSize.megabytes * 1000.f / m_time.mean << " MB/s, "
+                  << m_params.inputSize.megapixels * 1000.f / m_time.mean << " MP/s"
+                  << std::defaultfloat << std::setprecision(precision);
+    }
+
+    if (m_memory.hasAllocationCounts) {
+        std::cout << " | " << std::fixed << std::setprecision(1)
+                  << m_memory.allocationsPerInference << " allocations, "
+                  << m_memory.bytesPerInference / 1000.f << " kB per inference"
+                  << std::defaultfloat << std::setprecision(precision);
+    }
+
+    if (m_perfCounters.isAvailable && m_perfCounters.cycles > 0.0 &&
+        m_perfCounters.instructions >= 0.0) {
+        std::cout << " | IPC = " << std::fixed << std::setprecision(2)
+                  << m_perfCounters.instructions / m_perfCounters.cycles << std::defaultfloat
+                  << std::setprecision(precision);
+    }
+
+    std::cout << " | " << m_params.numIterations << " iterations";
+    if (m_stopReason != StopReason::FIXED_COUNT) {
+        std::cout << " (" << toString(m_stopReason) << ", +/- " << std::fixed
+                  << std::setprecision(1) << m_time.relativeError * 100.f << "%)"
+                  << std::defaultfloat << std::setprecision(precision);
+    }
+
+    // the times of a throttled or slowed down CPU are not comparable to the others
+    if (m_environment.isThrottled) {
+        std::cout << " | THROTTLED (" << m_environment.throttledPeriods << " periods, "
+                  << std::fixed << std::setprecision(1) << m_environment.throttledTime << " ms)"
+                  << std::defaultfloat << std::setprecision(precision);
+    }
+    if (m_environment.isFrequencyDropped) {
+        std::cout << " | CPU frequency dropped from " << std::fixed << std::setprecision(0)
+                  << m_environment.frequencyBefore << " to " << m_environment.frequencyAfter
+                  << " MHz" << std::defaultfloat << std::setprecision(precision);
+    }
+    std::cout << std::endl;
 }
 
-TimeResult summarizeTimes(const Parameters &params, std::vector<float> times) {
+std::vector<float> normalizeTimes(const Parameters &params, const std::vector<float> &times) {
     //
     // times should be passed in NANOSECONDS as milliseconds do not have the resolution for
-    // some individual executions. So, the following divide through by 1000 to convert to ms
-    // for consumption down stream AFTER the calculations are done.
+    // some individual executions. They are divided by the batch size and converted to ms here.
     //
-    std::transform(times.begin(), times.end(), times.begin(),
-                   [&params](float val) { return val / static_cast<float>(params.batchSize); });
-    auto total = std::accumulate(times.begin(), times.end(), 0.0f);
-    auto mean = total / params.numIterations;
+    constexpr double nsPerMs{1000.0 * 1000.0};
+    std::vector<float> normalized;
+    normalized.reserve(times.size());
+    for (auto time : times) {
+        normalized.push_back(static_cast<float>(time / params.batchSize / nsPerMs));
+    }
+    return normalized;
+}
+
+LatencyHistogram makeHistogram(const std::vector<float> &times) {
+    // the histogram buckets integer values, so record in nanoseconds
+    constexpr double nsPerMs{1000.0 * 1000.0};
+    LatencyHistogram histogram;
+    for (auto time : times) {
+        histogram.record(static_cast<uint64_t>(time * nsPerMs + 0.5));
+    }
+    return histogram;
+}
+
+TimeResult summarizeTimes(const std::vector<float> &times, const LatencyHistogram &histogram,
+                          StoppingStatistic statistic) {
+    if (times.empty()) {
+        return TimeResult{};
+    }
+
+    // accumulate in double precision, concurrent runs pass the iterations of every thread
+    const double total = std::accumulate(times.begin(), times.end(), 0.0);
+    const double mean = total / times.size();
     const auto minmax = std::minmax_element(times.begin(), times.end());
 
-    const size_t sz = times.size();
-    auto variance_func = [&mean, &sz](float accumulator, const float &val) {
-        return accumulator + ((val - mean) * (val - mean) / (sz - 1));
-    };
-    auto variance = std::accumulate(times.begin(), times.end(), 0.0f, variance_func) / 1000.f;
+    double sumOfSquares = 0.0;
+    for (auto time : times) {
+        sumOfSquares += (time - mean) * (time - mean);
+    }
+    const double variance = times.size() > 1 ? sumOfSquares / (times.size() - 1) : 0.0;
+
+    const auto ci = statistic == StoppingStatistic::P99
+                        ? quantileConfidenceInterval(times, 0.99, 0.95)
+                        : meanConfidenceInterval(times, 0.95);
+    const double relativeError =
+        ci.estimate > 0.0 ? (ci.high - ci.low) / 2.0 / ci.estimate : 0.0;
 
     constexpr float nsPerMs{1000.f * 1000.f};
-    return TimeResult{total / nsPerMs, mean / nsPerMs, variance / (nsPerMs * 1000.f),
-                      *minmax.first / nsPerMs, *minmax.second / nsPerMs};
+    return TimeResult{static_cast<float>(total),
+                      static_cast<float>(mean),
+                      static_cast<float>(variance),
+                      *minmax.first,
+                      *minmax.second,
+                      histogram.getValueAtPercentile(50.0) / nsPerMs,
+                      histogram.getValueAtPercentile(90.0) / nsPerMs,
+                      histogram.getValueAtPercentile(99.0) / nsPerMs,
+                      histogram.getValueAtPercentile(99.9) / nsPerMs,
+                      static_cast<float>(relativeError)};
+}
+
+Observation::Observation(const std::string &version, bool isGpuEnabled,
+                         const std::string &benchmarkName, const std::string &benchmarkSubType,
+                         const Parameters &params, const std::vector<float> &times,
+                         const MemoryProfile &memory, StopReason stopReason,
+                         const PerfCounterResult &perfCounters,
+                         const CpuEnvironmentResult &environment)
+    : m_version{version}, m_isGpuEnabled{isGpuEnabled}, m_benchmarkName{benchmarkName},
+      m_benchmarkSubType{benchmarkSubType}, m_params{params},
+      m_times{normalizeTimes(params, times)}, m_histogram{makeHistogram(m_times)},
+      m_time{summarizeTimes(m_times, m_histogram, params.adaptive.statistic)},
+      m_memory{memory}, m_stopReason{stopReason}, m_perfCounters{perfCounters},
+      m_environment{environment} {
+    const float inferencesPerSecond = m_time.mean > 0.f ? 1000.f / m_time.mean : 0.f;
+    m_throughput = ThroughputResult{ConcurrencyMode::SINGLE_THREAD, 1, inferencesPerSecond, 1.f,
+                                    {m_time.mean}};
+    emitToUser();
 }
 
 Observation::Observation(const std::string &version, bool isGpuEnabled,
                          const std::string &benchmarkName, const std::string &benchmarkSubType,
                          const Parameters &params, const std::vector<float> &times,
-                         float memoryUsage)
+                         const MemoryProfile &memory, const ThroughputResult &throughput,
+                         StopReason stopReason, const PerfCounterResult &perfCounters,
+                         const CpuEnvironmentResult &environment)
     : m_version{version}, m_isGpuEnabled{isGpuEnabled}, m_benchmarkName{benchmarkName},
-      m_benchmarkSubType{benchmarkSubType}, m_params{params}, m_time{summarizeTimes(params, times)},
-      m_memoryUsage{memoryUsage} {
+      m_benchmarkSubType{benchmarkSubType}, m_params{params},
+      m_times{normalizeTimes(params, times)}, m_histogram{makeHistogram(m_times)},
+      m_time{summarizeTimes(m_times, m_histogram, params.adaptive.statistic)},
+      m_memory{memory}, m_throughput{throughput}, m_stopReason{stopReason},
+      m_perfCounters{perfCounters}, m_environment{environment} {
     emitToUser();
 }
 
 std::ostream &operator<<(std::ostream &out, const Observation &o) {
     const auto &params = o.getParameters();
     const auto &time = o.getTimeResult();
+    const auto &throughput = o.getThroughput();
     auto precision{out.precision()};
     out << o.getVersion() << ", " << (o.getIsGpuEnabled() ? "GPU" : "CPU") << ","
         << "\"" << o.getBenchmarkName() << "\","
         << "\"" << o.getBenchmarkSubType() << "\"," << params.batchSize << ","
-        << params.numIterations << "," << std::fixed << std::setprecision(3) << time.total << ","
+        << params.numIterations << "," << (params.doWarmup ? params.numWarmup : 0) << ","
+        << "\"" << toString(o.getStopReason()) << "\"," << std::fixed << std::setprecision(3)
+        << time.total << ","
         << time.mean << "," << time.variance << "," << time.low << "," << time.high << ","
-        << o.getMemoryUsage()
-        // reset iomanip
-        << std::defaultfloat << std::setprecision(precision);
+        << time.p50 << "," << time.p90 << "," << time.p99 << "," << time.p999 << ","
+        << time.relativeError * 100.f << ","
+        << o.getMemoryUsage() << ",";
+
+    const auto &memory = o.getMemoryProfile();
+    out << memory.peakRss << "," << memory.peakPss << ",";
+    if (memory.hasAllocationCounts) {
+        out << memory.allocationsPerInference << "," << memory.bytesPerInference << ","
+            << memory.liveHeapGrowth << ",";
+    } else {
+        out << ",,,";
+    }
+
+    // leave the counters that are not available empty
+    const auto &perf = o.getPerfCounters();
+    const auto printCount = [&out, &perf](double count) {
+        if (perf.isAvailable && count >= 0.0) {
+            out << count;
+        }
+        out << ",";
+    };
+    printCount(perf.cycles > 0.0 && perf.instructions >= 0.0 ? perf.instructions / perf.cycles
+                                                             : -1.0);
+    printCount(perf.cycles);
+    printCount(perf.instructions);
+    printCount(perf.llcMisses);
+    printCount(perf.branchMisses);
+    printCount(perf.contextSwitches);
+
+    out << params.inferenceThreading.numThreads << ","
+        << (params.inferenceThreading.useGlobalThreadpool ? "on" : "off") << ","
+        << throughput.numThreads << ","
+        << "\"" << toString(throughput.mode) << "\"," << throughput.inferencesPerSecond << ","
+        << throughput.scalingEfficiency << ",\"";
+    for (size_t i = 0; i < throughput.perThreadMean.size(); ++i) {
+        out << (i ? " " : "") << throughput.perThreadMean[i];
+    }
+    out << "\",";
+
+    // leave the data rates of the benchmarks without an image input empty
+    const auto &inputSize = params.inputSize;
+    if (inputSize.megapixels > 0.f && time.mean > 0.f) {
+        out << inputSize.megabytes << "," << inputSize.megapixels << ","
+            << inputSize.megabytes * 1000.f / time.mean << ","
+            << inputSize.megapixels * 1000.f / time.mean;
+    } else {
+        out << ",,,";
+    }
+
+    // leave the CPU environment empty where it is not known
+    const auto &environment = o.getCpuEnvironment();
+    out << ",";
+    if (environment.isAvailable) {
+        // no quota is left empty as well
+        if (environment.cpuQuota > 0.f) {
+            out << environment.cpuQuota;
+        }
+        out << "," << environment.throttledPeriods << "," << environment.throttledTime << ",";
+        if (environment.frequencyBefore > 0.f && environment.frequencyAfter > 0.f) {
+            out << environment.frequencyBefore << "," << environment.frequencyAfter << ",";
+        } else {
+            out << ",,";
+        }
+        out << "\"" << environment.governor << "\",";
+        if (environment.smtActive >= 0) {
+            out << (environment.smtActive ? "on" : "off");
+        }
+        out << "," << environment.numAllowedCpus << ","
+            << (environment.isThrottled ? "yes" : "no") << ","
+            << (environment.isFrequencyDropped ? "yes" : "no");
+    } else {
+        out << ",,,,,,,,,";
+    }
+
+    // reset iomanip
+    out << std::defaultfloat << std::setprecision(precision);
 
     return out;
 }
 
-ObservationCSVWriter::ObservationCSVWriter(const std::string &path)
-    : m_path{path}, m_writeHeaders{!doesFileExist(path)} {}
+ObservationCSVWriter::ObservationCSVWriter(const std::string &path, const HostInfo &host)
+    : m_path{path}, m_host{host} {}
 
 void ObservationCSVWriter::write(const ObservationList &observations) {
+    const std::string header =
+        "SDK Version, GPU or CPU, Benchmark Name, Benchmark Type or Model, Batch Size, "
+        "Number of Iterations, Warmup Iterations, Stop Reason, "
+        "Total Time (ms), Mean Time (ms), Variance (ms^2), Low (ms), High (ms), "
+        "p50 (ms), p90 (ms), p99 (ms), p99.9 (ms), "
+        "95% CI Half Width (%), "
+        "Memory Usage (MB), Peak RSS (MB), Peak PSS (MB), "
+        "Allocations per Inference, Bytes Allocated per Inference, "
+        "Live Heap Growth (MB), "
+        "IPC, Cycles per Inference, Instructions per Inference, "
+        "LLC Misses per Inference, Branch Misses per Inference, "
+        "Context Switches per Inference, "
+        "Inference Threads, Global Inference Threadpool, "
+        "Threads, Concurrency Mode, Throughput (inferences/s), Scaling Efficiency, "
+        "Per-thread Mean (ms), "
+        "Input Size (MB), Input Size (MP), Data Rate (MB/s), Pixel Rate (MP/s), "
+        "CPU Quota (cores), Throttled Periods, Throttled Time (ms), "
+        "CPU Frequency Before (MHz), CPU Frequency After (MHz), Governor, SMT, "
+        "Allowed CPUs, Throttled, Frequency Dropped, "
+        "Host Fingerprint, Run Timestamp";
+
+    // The rows are appended to the file of the previous runs, unless it has other columns
+    std::string existingHeader;
+    const bool writeHeader = !readHeader(m_path, existingHeader) || existingHeader != header;
+    if (writeHeader && !existingHeader.empty()) {
+        const std::string oldPath = m_path + ".old";
+        if (std::rename(m_path.c_str(), oldPath.c_str()) != 0) {
+            std::cout << "Error: unable to move " << m_path << ", written with other columns, to "
+                      << oldPath << std::endl;
+            return;
+        }
+        std::cout << "Moved " << m_path << ", written with other columns, to " << oldPath
+                  << std::endl;
+    }
+
     // write observations to a csv
     std::ofstream out{m_path, std::ios::app};
-    if (m_writeHeaders) {
-        out << "SDK Version, "
-            << "GPU or CPU, "
-            << "Benchmark Name, "
-            << "Benchmark Type or Model, "
-            << "Batch Size, "
-            << "Number of Iterations, "
-            << "Total Time (ms), Mean Time (ms), Variance (ms), Low (ms), High (ms), "
-            << "Memory Usage (MB)"
-            << "\n";
+    if (writeHeader) {
+        out << header << "\n";
     }
 
     for (const auto &observation : observations) {
-        out << observation << "\n";
+        out << observation << "," << m_host.fingerprint << "," << m_host.timestamp << "\n";
     }
 
     out.close();
 }
 
-bool ObservationCSVWriter::doesFileExist(const std::string &path) {
-    std::ifstream f{m_path};
-    return f.good();
+bool ObservationCSVWriter::readHeader(const std::string &path, std::string &header) {
+    std::ifstream f{path};
+    return static_cast<bool>(std::getline(f, header));
+}
+
+RawTimesCSVWriter::RawTimesCSVWriter(const std::string &path, const HostInfo &host)
+    : m_path{path}, m_host{host} {}
+
+void RawTimesCSVWriter::write(const ObservationList &observations) {
+    std::ofstream out{m_path};
+    out << "# CPU Model: " << m_host.cpuModel << "\n"
+        << "# ISA Flags: " << m_host.isaFlags << "\n"
+        << "# Cores: " << m_host.numCores << "\n"
+        << "# SDK Version: " << m_host.sdkVersion << "\n"
+        << "# Host Fingerprint: " << m_host.fingerprint << "\n"
+        << "# Run Timestamp: " << m_host.timestamp << "\n";
+    out << "Benchmark Name, Benchmark Type or Model, Batch Size, Threads, Concurrency Mode, "
+        << "Iteration, Time (ms)"
+        << "\n";
+
+    for (const auto &observation : observations) {
+        const auto &params = observation.getParameters();
+        const auto &throughput = observation.getThroughput();
+        const auto &times = observation.getTimes();
+        for (size_t i = 0; i < times.size(); ++i) {
+            out << "\"" << observation.getBenchmarkName() << "\","
+                << "\"" << observation.getBenchmarkSubType() << "\"," << params.batchSize << ","
+                << throughput.numThreads << ",\"" << toString(throughput.mode) << "\"," << i << ","
+                << std::fixed << std::setprecision(6) << times[i] << "\n";
+        }
+    }
+
+    out.close();
+}
+
+SweepCSVWriter::SweepCSVWriter(const std::string &path) : m_path{path} {}
+
+void SweepCSVWriter::write(const ObservationList &observations) {
+    std::ofstream out{m_path, std::ios::app};
+    for (const auto &observation : observations) {
+        const auto &params = observation.getParameters();
+        const auto &time = observation.getTimeResult();
+        const auto &throughput = observation.getThroughput();
+        const auto numInferenceThreads = std::max(1u, params.inferenceThreading.numThreads);
+        out << "\"" << observation.getBenchmarkName() << "\","
+            << "\"" << observation.getBenchmarkSubType() << "\"," << params.batchSize << ","
+            << throughput.numThreads << ",\"" << toString(throughput.mode) << "\","
+            << (params.inferenceThreading.useGlobalThreadpool ? "on" : "off") << ","
+            << params.inferenceThreading.numThreads << "," << std::fixed << std::setprecision(3)
+            << time.mean << "," << time.p99 << "," << throughput.inferencesPerSecond << ","
+            << throughput.inferencesPerSecond / (numInferenceThreads * throughput.numThreads)
+            << "\n";
+    }
+}
+
+void SweepCSVWriter::truncate(const std::string &path) {
+    std::ofstream out{path};
+    out << "Benchmark Name, Benchmark Type or Model, Batch Size, Threads, Concurrency Mode, "
+        << "Global Inference Threadpool, Inference Threads, Mean Time (ms), p99 (ms), "
+        << "Throughput (inferences/s), Throughput per Core (inferences/s)"
+        << "\n";
 }
 
 } // namespace Benchmarks
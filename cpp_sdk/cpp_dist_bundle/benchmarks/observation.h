@@ -1,5 +1,9 @@
 #pragma once
 
+#include "host_info.h"
+#include "latency_histogram.h"
+
+#include <cstdint>
 #include <iosfwd>
 #include <string>
 #include <vector>
@@ -7,11 +11,75 @@
 namespace Trueface {
 namespace Benchmarks {
 
+// Statistic whose confidence interval decides when the adaptive mode stops iterating
+enum class StoppingStatistic { MEAN, P99 };
+
+// Why the timed iterations of an observation stopped
+enum class StopReason { FIXED_COUNT, CONFIDENCE_TARGET, TIME_BUDGET, MAX_ITERATIONS };
+
+struct AdaptiveOptions {
+    // When disabled, numWarmup warmup iterations and numIterations timed iterations are run.
+    // When enabled, at least numWarmup warmup iterations are run until the latency settles, then
+    // the inference is timed until the confidence interval of the statistic is narrow enough or
+    // the time budget runs out. numIterations is ignored.
+    bool enabled;
+    StoppingStatistic statistic;
+    // Target half width of the 95% confidence interval, as a fraction of the statistic
+    float targetRelativeError;
+    // Time budget of the warmup and timed iterations of one benchmark, in seconds
+    float timeBudget;
+    unsigned int minIterations;
+    unsigned int maxIterations;
+};
+
+struct ColdStartOptions {
+    // When enabled, the benchmarks measure the model load and first inference in fresh processes
+    // instead of the steady state latency
+    bool enabled;
+    unsigned int numRepetitions;
+};
+
+enum class ArrivalProcess { CONSTANT, POISSON };
+
+struct OpenLoopOptions {
+    // When enabled, the inference is also driven open loop: requests arrive at a sweep of rates
+    // whether or not the previous ones have completed, and their latency is measured from their
+    // scheduled arrival, so the time spent queueing is included
+    bool enabled;
+    ArrivalProcess arrivals;
+    // Offered rates in requests per second. When empty, fractions of the closed loop capacity.
+    std::vector<float> rates;
+    // Duration of the arrivals at every rate, in seconds
+    float duration;
+};
+
+struct InferenceThreading {
+    // Value of OMP_NUM_THREADS, which sets the number of threads used by every inference.
+    // 0 when not set, in which case the SDK uses all the cores.
+    unsigned int numThreads;
+    // Value of ConfigurationOptions.useGlobalInferenceThreadpool
+    bool useGlobalThreadpool;
+};
+
+struct InputSize {
+    // Size of the input of one inference, used to report the data and pixel rates.
+    // Zero for the benchmarks which do not process a whole image.
+    float megabytes;
+    float megapixels;
+};
+
 struct Parameters {
     bool doWarmup;
     int numWarmup;
     unsigned int batchSize;
     unsigned int numIterations;
+    // Number of concurrent threads for the throughput mode. 0 or 1 only measures latency.
+    unsigned int numThreads;
+    AdaptiveOptions adaptive;
+    ColdStartOptions coldStart;
+    InferenceThreading inferenceThreading;
+    InputSize inputSize;
+    OpenLoopOptions openLoop;
 };
 
 struct TimeResult {
@@ -20,13 +88,87 @@ struct TimeResult {
     float variance;
     float low;
     float high;
+    float p50;
+    float p90;
+    float p99;
+    float p999;
+    // Half width of the 95% confidence interval of the stopping statistic, as a fraction of it
+    float relativeError;
+};
+
+struct MemoryProfile {
+    // Growth of the peak resident memory over the benchmark, including the model load, in MB
+    float memoryUsage;
+    // Largest resident and proportional set sizes sampled during the benchmark, in MB
+    float peakRss;
+    float peakPss;
+    // Only measured when the malloc hook is loaded, see malloc_hook.cpp
+    bool hasAllocationCounts;
+    float allocationsPerInference;
+    float bytesPerInference;
+    // Growth of the live heap over the timed iterations, in MB. Positive values hint at a leak
+    // or at caches growing with every inference.
+    float liveHeapGrowth;
+};
+
+// Hardware and scheduler counters of the timed iterations, see perf_counters.h
+struct PerfCounterResult {
+    bool isAvailable;
+    // Counts per inference, negative when the counter is not available
+    double cycles;
+    double instructions;
+    double llcMisses;
+    double branchMisses;
+    double contextSwitches;
+};
+
+// CPU quota throttling and frequency over the timed iterations, see cpu_environment.h
+struct CpuEnvironmentResult {
+    bool isAvailable;
+    // Tightest CPU quota of the cgroup in cores, 0 when unlimited
+    float cpuQuota;
+    // Periods in which the cgroup was throttled, and the time it was throttled for in ms
+    uint64_t throttledPeriods;
+    float throttledTime;
+    // Mean frequency of the allowed CPUs when the iterations started and stopped in MHz, 0 when
+    // unknown
+    float frequencyBefore;
+    float frequencyAfter;
+    std::string governor;
+    // 1 when simultaneous multithreading is active, 0 when not, -1 when unknown
+    int smtActive;
+    unsigned int numAllowedCpus;
+    // Set when the quota throttled the process, or when the frequency dropped by more than 10%
+    bool isThrottled;
+    bool isFrequencyDropped;
+};
+
+enum class ConcurrencyMode { SINGLE_THREAD, SHARED_SDK, SDK_PER_THREAD };
+
+struct ThroughputResult {
+    ConcurrencyMode mode;
+    unsigned int numThreads;
+    float inferencesPerSecond;
+    // Ratio of the aggregate throughput to numThreads times the single threaded throughput
+    float scalingEfficiency;
+    std::vector<float> perThreadMean;
 };
 
 class Observation {
 public:
     Observation(const std::string &version, bool isGpuEnabled, const std::string &benchmarkName,
                 const std::string &benchmarkSubType, const Parameters &params,
-                const std::vector<float> &times, float memoryUsage);
+                const std::vector<float> &times, const MemoryProfile &memory,
+                StopReason stopReason = StopReason::FIXED_COUNT,
+                const PerfCounterResult &perfCounters = PerfCounterResult{},
+                const CpuEnvironmentResult &environment = CpuEnvironmentResult{});
+    Observation(const std::string &version, bool isGpuEnabled, const std::string &benchmarkName,
+                const std::string &benchmarkSubType, const Parameters &params,
+                const std::vector<float> &times, const MemoryProfile &memory,
+                const ThroughputResult &throughput,
+                StopReason stopReason = StopReason::FIXED_COUNT,
+                const PerfCounterResult &perfCounters = PerfCounterResult{},
+                const CpuEnvironmentResult &environment = CpuEnvironmentResult{});
 
     const std::string &getVersion() const { return m_version; }
     bool getIsGpuEnabled() const { return m_isGpuEnabled; }
@@ -34,7 +176,15 @@ public:
     const std::string &getBenchmarkSubType() const { return m_benchmarkSubType; }
     const Parameters &getParameters() const { return m_params; }
     const TimeResult &getTimeResult() const { return m_time; }
-    float getMemoryUsage() const { return m_memoryUsage; }
+    const LatencyHistogram &getHistogram() const { return m_histogram; }
+    // time of every iteration in ms, divided by the batch size
+    const std::vector<float> &getTimes() const { return m_times; }
+    float getMemoryUsage() const { return m_memory.memoryUsage; }
+    const MemoryProfile &getMemoryProfile() const { return m_memory; }
+    const ThroughputResult &getThroughput() const { return m_throughput; }
+    StopReason getStopReason() const { return m_stopReason; }
+    const PerfCounterResult &getPerfCounters() const { return m_perfCounters; }
+    const CpuEnvironmentResult &getCpuEnvironment() const { return m_environment; }
 
 private:
     void emitToUser();
@@ -44,8 +194,14 @@ private:
     std::string m_benchmarkName;
     std::string m_benchmarkSubType;
     Parameters m_params;
+    std::vector<float> m_times;
+    LatencyHistogram m_histogram;
     TimeResult m_time;
-    float m_memoryUsage;
+    MemoryProfile m_memory;
+    ThroughputResult m_throughput;
+    StopReason m_stopReason;
+    PerfCounterResult m_perfCounters;
+    CpuEnvironmentResult m_environment;
 };
 
 std::ostream &operator<<(std::ostream &, const Observation &);
@@ -54,14 +210,44 @@ using ObservationList = std::vector<Observation>;
 
 class ObservationCSVWriter {
 public:
-    ObservationCSVWriter(const std::string &path);
+    ObservationCSVWriter(const std::string &path, const HostInfo &host);
+
+    void write(const ObservationList &);
+
+private:
+    // Reads the first line of the file, false when it does not exist or is empty
+    bool readHeader(const std::string &path, std::string &header);
+    std::string m_path;
+    HostInfo m_host;
+};
+
+// Writes the time of every iteration of every observation, one row per iteration, for offline
+// analysis of the latency distribution and for compare_benchmarks. The host description is
+// written first as "# key: value" lines.
+class RawTimesCSVWriter {
+public:
+    RawTimesCSVWriter(const std::string &path, const HostInfo &host);
+
+    void write(const ObservationList &);
+
+private:
+    std::string m_path;
+    HostInfo m_host;
+};
+
+// Appends one row per observation with the latency and throughput for the inference thread count
+// and threadpool setting, for plotting the scaling curve of every module
+class SweepCSVWriter {
+public:
+    SweepCSVWriter(const std::string &path);
 
     void write(const ObservationList &);
 
+    // Starts a new sweep file with only the header
+    static void truncate(const std::string &path);
+
 private:
-    bool doesFileExist(const std::string &path);
-    const std::string &m_path;
-    bool m_writeHeaders;
+    std::string m_path;
 };
 
 } // namespace Benchmarks
@@ -0,0 +1,225 @@
+#include "open_loop.h"
+
+#include "tf_data_types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Fractions of the closed loop capacity offered when no rates are given, denser around the
+// capacity where the knee usually is
+const std::vector<float> defaultLoadFactors{0.25f, 0.5f, 0.7f, 0.8f, 0.9f, 0.95f, 1.f, 1.1f};
+
+// Requests which have not started after this many times the duration are given up on, so that
+// a rate far beyond the capacity does not run forever
+constexpr float maxDurationFactor{2.f};
+
+// A rate is saturated when its p99 latency exceeds this many times the p99 latency of the lowest
+// rate, or when less than minServedFraction of the offered rate is served
+constexpr float maxP99Growth{2.f};
+constexpr float minServedFraction{0.95f};
+
+struct RateResult {
+    // latency of every served request from its scheduled arrival, in ns
+    std::vector<float> times;
+    std::vector<float> perWorkerMean;
+    size_t numScheduled;
+    float achievedRate;
+};
+
+// Arrival times of the requests from the start, in seconds
+std::vector<double> scheduleArrivals(ArrivalProcess arrivals, float rate, float duration,
+                                     uint32_t seed) {
+    std::vector<double> schedule;
+    if (arrivals == ArrivalProcess::CONSTANT) {
+        for (size_t i = 0; i < rate * duration; ++i) {
+            schedule.push_back(i / rate);
+        }
+        return schedule;
+    }
+
+    std::mt19937 engine{seed};
+    std::exponential_distribution<double> interarrival{rate};
+    for (double time = interarrival(engine); time < duration; time += interarrival(engine)) {
+        schedule.push_back(time);
+    }
+    return schedule;
+}
+
+bool runAtRate(const std::vector<Inference> &workers, const std::vector<double> &schedule,
+               float duration, const std::string &benchmarkName, RateResult &result) {
+    const auto numWorkers = workers.size();
+    std::vector<std::vector<float>> workerTimes(numWorkers);
+    std::atomic<size_t> nextRequest{0};
+    std::atomic<bool> isFailed{false};
+
+    // leave the workers time to start before the first arrival
+    const auto start = Clock::now() + std::chrono::milliseconds(10);
+    const auto giveUp = start + std::chrono::duration_cast<Clock::duration>(
+                                    std::chrono::duration<float>(maxDurationFactor * duration));
+
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < numWorkers; ++w) {
+        workerTimes[w].reserve(schedule.size() / numWorkers + 1);
+        threads.emplace_back([&, w]() {
+            while (!isFailed) {
+                const size_t i = nextRequest++;
+                if (i >= schedule.size() || Clock::now() > giveUp) {
+                    break;
+                }
+                const auto arrival = start + std::chrono::duration_cast<Clock::duration>(
+                                                 std::chrono::duration<double>(schedule[i]));
+                std::this_thread::sleep_until(arrival);
+                if (workers[w]() != ErrorCode::NO_ERROR) {
+                    isFailed = true;
+                    break;
+                }
+                workerTimes[w].emplace_back(
+                    std::chrono::duration<float, std::nano>(Clock::now() - arrival).count());
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (isFailed) {
+        std::cout << "Error: Unable to run " << benchmarkName << std::endl;
+        return false;
+    }
+    const float elapsed = std::chrono::duration<float>(Clock::now() - start).count();
+
+    constexpr float nsPerMs{1000.f * 1000.f};
+    result.times.clear();
+    result.perWorkerMean.clear();
+    for (const auto &times : workerTimes) {
+        const auto total = std::accumulate(times.begin(), times.end(), 0.0);
+        result.perWorkerMean.push_back(
+            times.empty() ? 0.f : static_cast<float>(total / times.size() / nsPerMs));
+        result.times.insert(result.times.end(), times.begin(), times.end());
+    }
+    result.numScheduled = schedule.size();
+    result.achievedRate = result.times.size() / std::max(elapsed, duration);
+    return true;
+}
+
+std::string formatRate(float rate) {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(rate < 10.f ? 2 : rate < 100.f ? 1 : 0) << rate;
+    return stream.str();
+}
+
+} // namespace
+
+void runOpenLoop(const std::vector<Inference> &workers, float singleThreadMean,
+                 const std::string &version, bool isGpuEnabled, const std::string &benchmarkName,
+                 const std::string &benchmarkSubType, const Parameters &params,
+                 ObservationList &observations) {
+    const auto &openLoop = params.openLoop;
+    const auto numWorkers = static_cast<unsigned int>(workers.size());
+    // requests per second the workers serve back to back in the closed loop
+    const float capacity =
+        singleThreadMean > 0.f ? numWorkers * 1000.f / (singleThreadMean * params.batchSize) : 0.f;
+
+    auto rates = openLoop.rates;
+    if (rates.empty()) {
+        for (auto factor : defaultLoadFactors) {
+            rates.push_back(factor * capacity);
+        }
+    }
+    std::sort(rates.begin(), rates.end());
+    rates.erase(std::remove_if(rates.begin(), rates.end(), [](float rate) { return rate <= 0.f; }),
+                rates.end());
+    if (rates.empty()) {
+        return;
+    }
+
+    // A request is one inference, the latency of a batch is not divided by the batch size
+    auto runParams = params;
+    runParams.doWarmup = false;
+    runParams.numWarmup = 0;
+    runParams.batchSize = 1;
+    runParams.numThreads = numWorkers;
+    runParams.adaptive.enabled = false;
+    runParams.inputSize = {};
+
+    std::string subType = benchmarkSubType.empty() ? "" : benchmarkSubType + ", ";
+    subType += openLoop.arrivals == ArrivalProcess::POISSON ? "open loop, Poisson"
+                                                            : "open loop, constant";
+
+    float lowestRateP99 = 0.f;
+    float lastUnsaturatedRate = 0.f;
+    float firstSaturatedRate = 0.f;
+    for (size_t i = 0; i < rates.size(); ++i) {
+        const float rate = rates[i];
+        const auto schedule =
+            scheduleArrivals(openLoop.arrivals, rate, openLoop.duration, static_cast<uint32_t>(i));
+        RateResult result{};
+        if (!runAtRate(workers, schedule, openLoop.duration, benchmarkName, result)) {
+            return;
+        }
+        if (result.times.empty()) {
+            continue;
+        }
+
+        runParams.numIterations = static_cast<unsigned int>(result.times.size());
+        observations.emplace_back(
+            version, isGpuEnabled, benchmarkName,
+            subType + ", " + formatRate(rate) + " requests/s", runParams, result.times,
+            MemoryProfile{},
+            ThroughputResult{numWorkers > 1 ? ConcurrencyMode::SHARED_SDK
+                                            : ConcurrencyMode::SINGLE_THREAD,
+                             numWorkers, result.achievedRate,
+                             capacity > 0.f ? result.achievedRate / capacity : 0.f,
+                             result.perWorkerMean});
+
+        const size_t numDropped = result.numScheduled - result.times.size();
+        std::cout << "  offered " << formatRate(rate) << " requests/s, served "
+                  << formatRate(result.achievedRate) << " requests/s";
+        if (numDropped > 0) {
+            std::cout << ", " << numDropped << " requests never started";
+        }
+        std::cout << std::endl;
+
+        const float p99 = observations.back().getTimeResult().p99;
+        if (lowestRateP99 == 0.f) {
+            lowestRateP99 = p99;
+        }
+        const bool isSaturated = numDropped > 0 ||
+                                 result.achievedRate < minServedFraction * rate ||
+                                 p99 > maxP99Growth * lowestRateP99;
+        if (isSaturated) {
+            firstSaturatedRate = rate;
+            break;
+        }
+        lastUnsaturatedRate = rate;
+    }
+
+    if (firstSaturatedRate == 0.f) {
+        std::cout << "No saturation up to " << formatRate(rates.back()) << " requests/s"
+                  << std::endl;
+    } else if (lastUnsaturatedRate == 0.f) {
+        std::cout << "Saturated from the lowest rate, " << formatRate(firstSaturatedRate)
+                  << " requests/s" << std::endl;
+    } else {
+        std::cout << "Saturation knee between " << formatRate(lastUnsaturatedRate) << " and "
+                  << formatRate(firstSaturatedRate)
+                  << " requests/s, where the p99 latency from arrival grows more than "
+                  << maxP99Growth << " times or the requests fall behind" << std::endl;
+    }
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
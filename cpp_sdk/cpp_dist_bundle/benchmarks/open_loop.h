@@ -0,0 +1,26 @@
+#pragma once
+
+#include "observation.h"
+#include "runner.h"
+
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Drives the inferences open loop at every rate of params.openLoop, for params.openLoop.duration
+// seconds each. Requests arrive on a constant or Poisson schedule and are served first come first
+// served by one worker per inference, so a request arriving while every worker is busy waits in
+// the queue. The latency of every request is measured from its scheduled arrival.
+// singleThreadMean is the closed loop latency of one inference in ms, divided by the batch size,
+// from which the default rates are derived. One request is one inference, so with a batch size
+// above 1 a request is a whole batch. The rates are run from the lowest up to the first one which
+// saturates, and the knee is printed.
+void runOpenLoop(const std::vector<Inference> &workers, float singleThreadMean,
+                 const std::string &version, bool isGpuEnabled, const std::string &benchmarkName,
+                 const std::string &benchmarkSubType, const Parameters &params,
+                 ObservationList &observations);
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,217 @@
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+#if defined(__linux__)
+int openCounter(uint32_t type, uint64_t config, pid_t tid) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    // also count the threads the thread creates after opening, their counts are summed on read
+    attr.inherit = 1;
+    attr.exclude_hv = 1;
+    // the running time tells how long the counter was scheduled when counters are multiplexed
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = static_cast<int>(::syscall(__NR_perf_event_open, &attr, tid, -1, -1, 0));
+    if (fd < 0 && errno != ESRCH) {
+        // kernel.perf_event_paranoid >= 2 only allows counting user space
+        attr.exclude_kernel = 1;
+        fd = static_cast<int>(::syscall(__NR_perf_event_open, &attr, tid, -1, -1, 0));
+    }
+    return fd;
+}
+
+// The threads of the process but the excluded ones, the calling thread first
+std::vector<pid_t> getThreads(const std::vector<int> &excludedThreads) {
+    const auto self = static_cast<pid_t>(::syscall(SYS_gettid));
+    std::vector<pid_t> threads{self};
+    DIR *dir = ::opendir("/proc/self/task");
+    if (!dir) {
+        return threads;
+    }
+    while (dirent *entry = ::readdir(dir)) {
+        const auto tid = static_cast<pid_t>(std::atoi(entry->d_name));
+        if (tid > 0 && tid != self &&
+            std::find(excludedThreads.begin(), excludedThreads.end(), tid) ==
+                excludedThreads.end()) {
+            threads.push_back(tid);
+        }
+    }
+    ::closedir(dir);
+    return threads;
+}
+
+// Opens the counter for every thread. A counter which cannot be opened for one of them, other than
+// because the thread exited meanwhile, is left out altogether as its count would be partial.
+std::vector<int> openCounters(uint32_t type, uint64_t config, const std::vector<pid_t> &threads) {
+    std::vector<int> fds;
+    for (auto tid : threads) {
+        const int fd = openCounter(type, config, tid);
+        if (fd >= 0) {
+            fds.push_back(fd);
+        } else if (errno != ESRCH || tid == threads.front()) {
+            static bool isReported = false;
+            if ((errno == EMFILE || errno == ENFILE) && !isReported) {
+                std::cout << "Warning: too many open files to count the " << threads.size()
+                          << " threads of the process, raise the limit with ulimit -n"
+                          << std::endl;
+                isReported = true;
+            }
+            for (auto opened : fds) {
+                ::close(opened);
+            }
+            return {};
+        }
+    }
+    return fds;
+}
+
+// Sum over the threads, negative when the counter is not available
+double readCounter(const std::vector<int> &fds) {
+    if (fds.empty()) {
+        return -1.0;
+    }
+
+    double total = 0.0;
+    for (auto fd : fds) {
+        uint64_t values[3] = {};
+        if (::read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) {
+            return -1.0;
+        }
+
+        // scale the count up to the whole time the counter was enabled
+        const auto enabled = values[1];
+        const auto running = values[2];
+        if (!running) {
+            if (enabled) {
+                return -1.0;
+            }
+            continue;
+        }
+        total += static_cast<double>(values[0]) * enabled / running;
+    }
+    return total;
+}
+#endif
+
+double perInference(double count, size_t numInferences) {
+    return count < 0.0 ? count : count / numInferences;
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {}
+
+PerfCounters::~PerfCounters() { close(); }
+
+void PerfCounters::close() {
+#if defined(__linux__)
+    for (auto &fds : m_fds) {
+        for (auto fd : fds) {
+            ::close(fd);
+        }
+        fds.clear();
+    }
+#endif
+}
+
+void PerfCounters::start(const std::vector<int> &excludedThreads) {
+    close();
+#if defined(__linux__)
+    // a counter opened with inherit only counts the threads created after it, so the thread pools
+    // which already exist are counted through counters of their own
+    const auto threads = getThreads(excludedThreads);
+    m_fds[CYCLES] = openCounters(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, threads);
+    m_fds[INSTRUCTIONS] = openCounters(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, threads);
+    // the generic cache misses event counts the misses of the last level cache
+    m_fds[LLC_MISSES] = openCounters(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, threads);
+    m_fds[BRANCH_MISSES] =
+        openCounters(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, threads);
+    m_fds[CONTEXT_SWITCHES] =
+        openCounters(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, threads);
+
+    static bool isReported = false;
+    if (m_fds[CYCLES].empty() && !isReported) {
+        std::cout << "Hardware performance counters are not available, check "
+                     "/proc/sys/kernel/perf_event_paranoid"
+                  << std::endl;
+        isReported = true;
+    }
+
+    // the ioctls also apply to the counters inherited by the threads created since
+    for (const auto &fds : m_fds) {
+        for (auto fd : fds) {
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)excludedThreads;
+#endif
+}
+
+void PerfCounters::stop() {
+#if defined(__linux__)
+    for (const auto &fds : m_fds) {
+        for (auto fd : fds) {
+            ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+#endif
+}
+
+void PerfCounters::resume() {
+#if defined(__linux__)
+    for (const auto &fds : m_fds) {
+        for (auto fd : fds) {
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+PerfCounterResult PerfCounters::getResult(size_t numInferences) const {
+    PerfCounterResult result{};
+#if defined(__linux__)
+    if (!numInferences) {
+        return result;
+    }
+
+    result.cycles = perInference(readCounter(m_fds[CYCLES]), numInferences);
+    result.instructions = perInference(readCounter(m_fds[INSTRUCTIONS]), numInferences);
+    result.llcMisses = perInference(readCounter(m_fds[LLC_MISSES]), numInferences);
+    result.branchMisses = perInference(readCounter(m_fds[BRANCH_MISSES]), numInferences);
+    result.contextSwitches = perInference(readCounter(m_fds[CONTEXT_SWITCHES]), numInferences);
+    result.isAvailable = result.cycles >= 0.0 || result.instructions >= 0.0 ||
+                         result.llcMisses >= 0.0 || result.branchMisses >= 0.0 ||
+                         result.contextSwitches >= 0.0;
+#else
+    (void)numInferences;
+#endif
+    return result;
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "observation.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Linux perf_event_open counters of every thread of the process, such as the thread pools of the
+// SDK, and of the threads they create afterwards. start() opens the counters of the threads which
+// exist at that point, so the pools created by an earlier benchmark are counted too, and they only
+// count between start() and stop(). Counters the kernel or the hardware does not support are left
+// out, which always happens on Windows and MacOS.
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // Closes the counters of a previous start(). The excluded threads, such as the memory samplers
+    // of the benchmarks, are not counted.
+    void start(const std::vector<int> &excludedThreads);
+    void stop();
+    // Counts again after stop(), adding to the counts so far
+    void resume();
+
+    // Counts between start() and stop() divided by the number of inferences
+    PerfCounterResult getResult(size_t numInferences) const;
+
+private:
+    enum Counter {
+        CYCLES,
+        INSTRUCTIONS,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        CONTEXT_SWITCHES,
+        NUM_COUNTERS
+    };
+
+    void close();
+
+    // One counter per thread
+    std::vector<int> m_fds[NUM_COUNTERS];
+};
+
+} // namespace Benchmarks
+} // namespace Trueface
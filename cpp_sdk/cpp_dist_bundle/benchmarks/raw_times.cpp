@@ -0,0 +1,103 @@
+#include "raw_times.h"
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+std::vector<std::string> splitCSVLine(const std::string &line) {
+    std::vector<std::string> fields;
+    std::string field;
+    bool inQuotes = false;
+    for (auto c : line) {
+        if (c == '"') {
+            inQuotes = !inQuotes;
+        } else if (c == ',' && !inQuotes) {
+            fields.push_back(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+    return fields;
+}
+} // namespace
+
+bool readRawTimesFile(const std::string &path, RawTimesFile &file) {
+    std::ifstream in{path};
+    if (!in.good()) {
+        std::cout << "Error: unable to open " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    bool headerSkipped = false;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        if (line[0] == '#') {
+            const auto colon = line.find(':');
+            if (colon != std::string::npos) {
+                const auto value = colon + 2 <= line.size() ? line.substr(colon + 2) : "";
+                file.metadata[line.substr(2, colon - 2)] = value;
+            }
+            continue;
+        }
+
+        if (!headerSkipped) {
+            headerSkipped = true;
+            continue;
+        }
+
+        // Benchmark Name, Benchmark Type or Model, Batch Size, Threads, Concurrency Mode,
+        // Iteration, Time (ms)
+        const auto fields = splitCSVLine(line);
+        RawTime time{};
+        bool isValid = fields.size() >= 7;
+        if (isValid) {
+            try {
+                time = RawTime{fields[0],
+                               fields[1],
+                               static_cast<unsigned int>(std::stoul(fields[2])),
+                               static_cast<unsigned int>(std::stoul(fields[3])),
+                               fields[4],
+                               std::stof(fields[6])};
+            } catch (const std::exception &) {
+                isValid = false;
+            }
+        }
+        if (!isValid) {
+            std::cout << "Error: unexpected line in " << path << ": " << line << std::endl;
+            return false;
+        }
+        file.times.push_back(time);
+    }
+
+    return true;
+}
+
+std::string getMetadata(const RawTimesFile &file, const std::string &key) {
+    auto it = file.metadata.find(key);
+    return it != file.metadata.end() ? it->second : "";
+}
+
+std::string getSeriesName(const RawTime &time) {
+    std::string name = time.benchmarkName;
+    if (!time.benchmarkSubType.empty()) {
+        name += " (" + time.benchmarkSubType + ")";
+    }
+    name += " | batch " + std::to_string(time.batchSize);
+    if (time.numThreads != 1) {
+        name += " | " + std::to_string(time.numThreads) + " threads, " + time.concurrencyMode;
+    }
+    return name;
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// One iteration of a raw times file written by run_benchmarks --raw-times
+struct RawTime {
+    std::string benchmarkName;
+    std::string benchmarkSubType;
+    unsigned int batchSize;
+    unsigned int numThreads;
+    // "single thread", "shared SDK" or "SDK per thread"
+    std::string concurrencyMode;
+    // Time of one inference, in ms
+    float time;
+};
+
+struct RawTimesFile {
+    // The "# key: value" lines, such as "SDK Version" and "Host Fingerprint"
+    std::map<std::string, std::string> metadata;
+    // In the order of the file
+    std::vector<RawTime> times;
+};
+
+// Reads a raw times file. Prints the error and returns false when it cannot be read.
+bool readRawTimesFile(const std::string &path, RawTimesFile &file);
+
+// Value of the metadata key, empty when the file does not have it
+std::string getMetadata(const RawTimesFile &file, const std::string &key);
+
+// Name of the benchmark, subtype, batch size and concurrency of the time, which the times of
+// different runs are matched by. For example "Face detection (FAST) | batch 1".
+std::string getSeriesName(const RawTime &time);
+
+} // namespace Benchmarks
+} // namespace Trueface
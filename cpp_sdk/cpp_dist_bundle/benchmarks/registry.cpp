@@ -0,0 +1,34 @@
+#include "registry.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+// Constructed on first use, as the registrations run during the static initialization of other
+// translation units
+std::vector<RegisteredBenchmark> &getRegistry() {
+    static std::vector<RegisteredBenchmark> registry;
+    return registry;
+}
+
+} // namespace
+
+BenchmarkRegistration::BenchmarkRegistration(const std::string &name, BenchmarkFunction run) {
+    getRegistry().push_back(RegisteredBenchmark{name, std::move(run)});
+}
+
+std::vector<RegisteredBenchmark> getRegisteredBenchmarks() {
+    auto benchmarks = getRegistry();
+    std::stable_sort(benchmarks.begin(), benchmarks.end(),
+                     [](const RegisteredBenchmark &a, const RegisteredBenchmark &b) {
+                         return a.name < b.name;
+                     });
+    return benchmarks;
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "observation.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+class Fixture;
+
+// What the run passes on to every registered benchmark
+struct SuiteContext {
+    // Parameters of a benchmark for a batch size and the number of timed iterations used with
+    // --fixed-iterations
+    std::function<Parameters(unsigned int batchSize, unsigned int numIterations)> params;
+    // Multiplies the numbers of iterations, inference is faster on GPU
+    unsigned int multFactor;
+    // Batch sizes of the methods which support batch inference
+    std::vector<unsigned int> batchSizes;
+};
+
+using BenchmarkFunction = std::function<void(Fixture &, const SuiteContext &, ObservationList &)>;
+
+struct RegisteredBenchmark {
+    std::string name;
+    BenchmarkFunction run;
+};
+
+// Adds a benchmark to the suite of run_benchmarks. Declared as a static object next to the
+// benchmark, so a new benchmark only needs its source file added to the target:
+//     const BenchmarkRegistration registration{"Blink detection", runBlinkDetection};
+class BenchmarkRegistration {
+public:
+    BenchmarkRegistration(const std::string &name, BenchmarkFunction run);
+};
+
+// The registered benchmarks sorted by name, so the order does not depend on the link order
+std::vector<RegisteredBenchmark> getRegisteredBenchmarks();
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,476 @@
+#include "runner.h"
+#include "allocation_counters.h"
+#include "cold_start.h"
+#include "cpu_environment.h"
+#include "fixture.h"
+#include "memory_high_water_mark.h"
+#include "open_loop.h"
+#include "perf_counters.h"
+#include "statistics.h"
+#include "stopwatch.h"
+#include "trace.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+bool runInference(const Inference &inference, const std::string &benchmarkName) {
+    auto errorCode = inference();
+    if (errorCode != ErrorCode::NO_ERROR) {
+        std::cout << "Error: Unable to run " << benchmarkName << std::endl;
+        std::cout << errorCode << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool warmup(const Inference &inference, const Parameters &params,
+            const std::string &benchmarkName, const std::string &benchmarkSubType) {
+    if (!params.doWarmup) {
+        return true;
+    }
+
+    IterationTrace trace(benchmarkName, benchmarkSubType, "warmup", params.numWarmup);
+    for (int i = 0; i < params.numWarmup; ++i) {
+        preciseStopwatch stopwatch;
+        if (!runInference(inference, benchmarkName)) {
+            return false;
+        }
+        trace.add(stopwatch.getStartPoint(),
+                  stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+    }
+
+    return true;
+}
+
+// Runs at least params.numWarmup warmup iterations, then keeps going until the median latency of
+// two consecutive windows agrees within warmupTolerance, which is when caches, lazily initialized
+// buffers and the CPU frequency have settled. Gives up after a quarter of the time budget.
+// Returns the number of warmup iterations, or -1 on error.
+int warmupUntilConverged(const Inference &inference, const Parameters &params,
+                         const std::string &benchmarkName, const std::string &benchmarkSubType) {
+    if (!params.doWarmup) {
+        return 0;
+    }
+
+    constexpr unsigned int windowSize = 5;
+    constexpr float warmupTolerance = 0.05f;
+    const float warmupBudget = params.adaptive.timeBudget / 4.f;
+
+    monotonicStopwatch budget;
+    IterationTrace trace(benchmarkName, benchmarkSubType, "warmup", params.numWarmup);
+    std::vector<float> window;
+    float previousMedian = 0.f;
+    int numWarmup = 0;
+    while (true) {
+        preciseStopwatch stopwatch;
+        if (!runInference(inference, benchmarkName)) {
+            return -1;
+        }
+        window.push_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+        trace.add(stopwatch.getStartPoint(), window.back());
+        ++numWarmup;
+
+        if (window.size() < windowSize) {
+            continue;
+        }
+
+        const float windowMedian = median(window);
+        window.clear();
+        const bool isConverged =
+            previousMedian > 0.f &&
+            std::abs(windowMedian - previousMedian) <= warmupTolerance * previousMedian;
+        previousMedian = windowMedian;
+
+        if ((isConverged && numWarmup >= params.numWarmup) ||
+            budget.elapsedTime<float, std::chrono::microseconds>() / 1e6f >= warmupBudget) {
+            return numWarmup;
+        }
+    }
+}
+
+// The times are reserved by the caller, so that the allocation counters only see the inferences
+void timeIterations(const Inference &inference, unsigned int numIterations,
+                    std::vector<float> &times, IterationTrace &trace) {
+    for (size_t i = 0; i < numIterations; ++i) {
+        preciseStopwatch stopwatch;
+        inference();
+        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+        trace.add(stopwatch.getStartPoint(), times.back());
+    }
+}
+
+// Times the inference until the 95% confidence interval of the stopping statistic is within the
+// target, the time budget left after the warmup runs out, or the maximum number of iterations is
+// reached. At least minIterations are always run. The checks of the confidence interval sort into
+// sorted, reserved by the caller like the times, and are not counted by the perf counters.
+void timeIterationsAdaptive(const Inference &inference, const AdaptiveOptions &adaptive,
+                            float timeBudget, std::vector<float> &times, std::vector<float> &sorted,
+                            PerfCounters &perfCounters, StopReason &stopReason,
+                            IterationTrace &trace) {
+    const auto minIterations = std::max(adaptive.minIterations, 2u);
+    monotonicStopwatch budget;
+    size_t nextCheck = minIterations;
+    while (true) {
+        preciseStopwatch stopwatch;
+        inference();
+        times.emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>());
+        trace.add(stopwatch.getStartPoint(), times.back());
+
+        if (times.size() < minIterations) {
+            continue;
+        }
+
+        if (adaptive.maxIterations && times.size() >= adaptive.maxIterations) {
+            stopReason = StopReason::MAX_ITERATIONS;
+            return;
+        }
+
+        if (budget.elapsedTime<float, std::chrono::microseconds>() / 1e6f >= timeBudget) {
+            stopReason = StopReason::TIME_BUDGET;
+            return;
+        }
+
+        // sorting for the confidence interval is O(n log n), so only check every 10% growth
+        if (times.size() >= nextCheck) {
+            perfCounters.stop();
+            const auto ci = adaptive.statistic == StoppingStatistic::P99
+                                ? quantileConfidenceInterval(times, 0.99, 0.95, sorted)
+                                : meanConfidenceInterval(times, 0.95);
+            perfCounters.resume();
+            if (ci.estimate > 0.0 &&
+                (ci.high - ci.low) / 2.0 <= adaptive.targetRelativeError * ci.estimate) {
+                stopReason = StopReason::CONFIDENCE_TARGET;
+                return;
+            }
+            nextCheck = times.size() + std::max<size_t>(minIterations, times.size() / 10);
+        }
+    }
+}
+
+// Combines the memory tracked over the whole benchmark with the allocations made since the
+// counters were read before the timed iterations
+MemoryProfile profileMemory(const MemoryHighWaterMarkTracker &memoryTracker,
+                            bool hasAllocationCounts, const AllocationCounters &before,
+                            size_t numInferences) {
+    MemoryProfile memory{};
+    memory.memoryUsage = memoryTracker.getDifferenceFromBaseline();
+    memory.peakRss = memoryTracker.getPeakRss();
+    memory.peakPss = memoryTracker.getPeakPss();
+
+    AllocationCounters after{};
+    if (hasAllocationCounts && numInferences && readAllocationCounters(after)) {
+        constexpr float bytesPerMB{1000.f * 1000.f};
+        memory.hasAllocationCounts = true;
+        memory.allocationsPerInference =
+            static_cast<float>(after.numAllocations - before.numAllocations) / numInferences;
+        memory.bytesPerInference =
+            static_cast<float>(after.bytesAllocated - before.bytesAllocated) / numInferences;
+        memory.liveHeapGrowth = (after.liveBytes - before.liveBytes) / bytesPerMB;
+    }
+    return memory;
+}
+
+// Runs every inference on its own thread. The threads are released together once they have all
+// been created so that the wall clock time only covers the concurrent section.
+ThroughputResult runConcurrently(ConcurrencyMode mode, const std::vector<Inference> &inferences,
+                                 const Parameters &params, float singleThreadMean,
+                                 const std::string &benchmarkName,
+                                 const std::string &benchmarkSubType, std::vector<float> &times) {
+    const auto numThreads = inferences.size();
+    std::vector<std::vector<float>> threadTimes(numThreads);
+    for (auto &t : threadTimes) {
+        t.reserve(params.numIterations);
+    }
+
+    std::mutex mtx;
+    std::condition_variable startCondVar;
+    bool start = false;
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&, i]() {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                startCondVar.wait(lock, [&start] { return start; });
+            }
+            IterationTrace trace(benchmarkName, benchmarkSubType,
+                                 mode == ConcurrencyMode::SHARED_SDK ? "shared SDK"
+                                                                     : "SDK per thread",
+                                 params.numIterations);
+            timeIterations(inferences[i], params.numIterations, threadTimes[i], trace);
+        });
+    }
+
+    preciseStopwatch wallClock;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        start = true;
+    }
+    startCondVar.notify_all();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const auto wallTime = wallClock.elapsedTime<float, std::chrono::nanoseconds>();
+
+    constexpr float nsPerMs{1000.f * 1000.f};
+    ThroughputResult result{mode, static_cast<unsigned int>(numThreads), 0.f, 0.f, {}};
+    times.clear();
+    for (const auto &t : threadTimes) {
+        const auto total = std::accumulate(t.begin(), t.end(), 0.0f);
+        result.perThreadMean.push_back(total / t.size() / params.batchSize / nsPerMs);
+        times.insert(times.end(), t.begin(), t.end());
+    }
+
+    const float numInferences = static_cast<float>(times.size()) * params.batchSize;
+    result.inferencesPerSecond = numInferences / (wallTime / (nsPerMs * 1000.f));
+    if (singleThreadMean > 0.f) {
+        const float singleThreadInferencesPerSecond = 1000.f / singleThreadMean;
+        result.scalingEfficiency =
+            result.inferencesPerSecond / (numThreads * singleThreadInferencesPerSecond);
+    }
+
+    return result;
+}
+
+void runThroughput(const SDKFactory &sdkFactory, const ConfigurationOptions &options,
+                   SDK &sharedSdk, const std::string &benchmarkName,
+                   const std::string &benchmarkSubType, const InferenceFactory &prepare,
+                   const Parameters &params, float singleThreadMean,
+                   ObservationList &observations) {
+    // One SDK instance shared by all the threads, as done by the thread pool sample app
+    {
+        MemoryHighWaterMarkTracker memoryTracker;
+        PerfCounters perfCounters;
+        CpuEnvironmentMonitor environment;
+
+        std::vector<Inference> inferences(params.numThreads);
+        for (auto &inference : inferences) {
+            if (!prepare(sharedSdk, inference) ||
+                !warmup(inference, params, benchmarkName, benchmarkSubType)) {
+                return;
+            }
+        }
+
+        AllocationCounters allocations{};
+        const bool hasAllocationCounts = readAllocationCounters(allocations);
+        std::vector<float> times;
+        environment.start();
+        perfCounters.start(MemoryHighWaterMarkTracker::getSamplerThreadIds());
+        auto throughput = runConcurrently(ConcurrencyMode::SHARED_SDK, inferences, params,
+                                          singleThreadMean, benchmarkName, benchmarkSubType,
+                                          times);
+        perfCounters.stop();
+        environment.stop();
+        const auto numInferences = times.size() * params.batchSize;
+        const auto memory =
+            profileMemory(memoryTracker, hasAllocationCounts, allocations, numInferences);
+        observations.emplace_back(sharedSdk.getVersion(), sdkFactory.isGpuEnabled(),
+                                  benchmarkName, benchmarkSubType, params, times, memory,
+                                  throughput, StopReason::FIXED_COUNT,
+                                  perfCounters.getResult(numInferences), environment.getResult());
+    }
+
+    // One SDK instance per thread. The extra memory of the instances is included.
+    {
+        MemoryHighWaterMarkTracker memoryTracker;
+        PerfCounters perfCounters;
+        CpuEnvironmentMonitor environment;
+
+        std::vector<std::unique_ptr<SDK>> sdks;
+        std::vector<Inference> inferences(params.numThreads);
+        for (auto &inference : inferences) {
+            sdks.emplace_back(new SDK(sdkFactory.createSDK(options)));
+            if (!prepare(*sdks.back(), inference) ||
+                !warmup(inference, params, benchmarkName, benchmarkSubType)) {
+                return;
+            }
+        }
+
+        AllocationCounters allocations{};
+        const bool hasAllocationCounts = readAllocationCounters(allocations);
+        std::vector<float> times;
+        environment.start();
+        perfCounters.start(MemoryHighWaterMarkTracker::getSamplerThreadIds());
+        auto throughput = runConcurrently(ConcurrencyMode::SDK_PER_THREAD, inferences, params,
+                                          singleThreadMean, benchmarkName, benchmarkSubType,
+                                          times);
+        perfCounters.stop();
+        environment.stop();
+        const auto numInferences = times.size() * params.batchSize;
+        const auto memory =
+            profileMemory(memoryTracker, hasAllocationCounts, allocations, numInferences);
+        observations.emplace_back(sharedSdk.getVersion(), sdkFactory.isGpuEnabled(),
+                                  benchmarkName, benchmarkSubType, params, times, memory,
+                                  throughput, StopReason::FIXED_COUNT,
+                                  perfCounters.getResult(numInferences), environment.getResult());
+    }
+}
+
+// Times the inference on the SDK returned by getSdk, which is called once the memory baseline is
+// read. sdkLoadMemory is added to the memory usage, for an instance created before.
+void runSteadyState(const SDKFactory &sdkFactory, const ConfigurationOptions &sdkOptions,
+                    const std::function<SDK &()> &getSdk, float sdkLoadMemory,
+                    const std::string &benchmarkName, const std::string &benchmarkSubType,
+                    const InferenceFactory &prepare, const Parameters &params,
+                    ObservationList &observations) {
+    // Baseline memory reading
+    MemoryHighWaterMarkTracker memoryTracker;
+    // Counts every thread of the process from start(), the SDK threads included and the memory
+    // samplers left out
+    PerfCounters perfCounters;
+    CpuEnvironmentMonitor environment;
+
+    SDK &tfSdk = getSdk();
+
+    Inference inference;
+    if (!prepare(tfSdk, inference)) {
+        return;
+    }
+
+    std::vector<float> times;
+    auto runParams = params;
+    auto stopReason = StopReason::FIXED_COUNT;
+    AllocationCounters allocations{};
+    bool hasAllocationCounts = false;
+    if (params.adaptive.enabled) {
+        monotonicStopwatch budget;
+        const int numWarmup =
+            warmupUntilConverged(inference, params, benchmarkName, benchmarkSubType);
+        if (numWarmup < 0) {
+            return;
+        }
+        std::vector<float> sorted;
+        if (params.adaptive.maxIterations) {
+            times.reserve(params.adaptive.maxIterations);
+            if (params.adaptive.statistic == StoppingStatistic::P99) {
+                sorted.reserve(params.adaptive.maxIterations);
+            }
+        }
+        IterationTrace trace(benchmarkName, benchmarkSubType, "timed", times.capacity());
+        hasAllocationCounts = readAllocationCounters(allocations);
+        const float remainingBudget = std::max(
+            0.f, params.adaptive.timeBudget -
+                     budget.elapsedTime<float, std::chrono::microseconds>() / 1e6f);
+        environment.start();
+        perfCounters.start(MemoryHighWaterMarkTracker::getSamplerThreadIds());
+        timeIterationsAdaptive(inference, params.adaptive, remainingBudget, times, sorted,
+                               perfCounters, stopReason, trace);
+        perfCounters.stop();
+        environment.stop();
+
+        // record what was actually run. The throughput mode reuses these counts.
+        runParams.numWarmup = numWarmup;
+        runParams.numIterations = static_cast<unsigned int>(times.size());
+    } else {
+        if (!warmup(inference, params, benchmarkName, benchmarkSubType)) {
+            return;
+        }
+        times.reserve(params.numIterations);
+        IterationTrace trace(benchmarkName, benchmarkSubType, "timed", params.numIterations);
+        hasAllocationCounts = readAllocationCounters(allocations);
+        environment.start();
+        perfCounters.start(MemoryHighWaterMarkTracker::getSamplerThreadIds());
+        timeIterations(inference, params.numIterations, times, trace);
+        perfCounters.stop();
+        environment.stop();
+    }
+
+    const auto numInferences = times.size() * params.batchSize;
+    auto memory = profileMemory(memoryTracker, hasAllocationCounts, allocations, numInferences);
+    memory.memoryUsage += sdkLoadMemory;
+    observations.emplace_back(tfSdk.getVersion(), sdkFactory.isGpuEnabled(), benchmarkName,
+                              benchmarkSubType, runParams, times, memory, stopReason,
+                              perfCounters.getResult(numInferences), environment.getResult());
+
+    const float singleThreadMean = observations.back().getTimeResult().mean;
+    if (params.numThreads > 1) {
+        runThroughput(sdkFactory, sdkOptions, tfSdk, benchmarkName, benchmarkSubType, prepare,
+                      runParams, singleThreadMean, observations);
+    }
+
+    if (params.openLoop.enabled) {
+        // One worker per thread, sharing the SDK
+        std::vector<Inference> workers{inference};
+        for (unsigned int i = 1; i < params.numThreads; ++i) {
+            Inference worker;
+            if (!prepare(tfSdk, worker) ||
+                !warmup(worker, runParams, benchmarkName, benchmarkSubType)) {
+                return;
+            }
+            workers.push_back(worker);
+        }
+        // every request is a batch
+        std::string subType = benchmarkSubType;
+        if (params.batchSize > 1) {
+            subType += (subType.empty() ? "batches of " : ", batches of ") +
+                       std::to_string(params.batchSize);
+        }
+        runOpenLoop(workers, singleThreadMean, tfSdk.getVersion(), sdkFactory.isGpuEnabled(),
+                    benchmarkName, subType, runParams, observations);
+    }
+}
+
+} // namespace
+
+void runBenchmark(const SDKFactory &sdkFactory, const ConfigurationOptions &options,
+                  const std::string &benchmarkName, const std::string &benchmarkSubType,
+                  const InferenceFactory &prepare, const Parameters &params,
+                  ObservationList &observations) {
+    auto sdkOptions = options;
+    sdkOptions.useGlobalInferenceThreadpool = params.inferenceThreading.useGlobalThreadpool;
+
+    if (params.coldStart.enabled) {
+        runColdStart(sdkFactory, sdkOptions, benchmarkName, benchmarkSubType, prepare, params,
+                     observations);
+        return;
+    }
+
+    std::unique_ptr<SDK> tfSdk;
+    auto createSdk = [&]() -> SDK & {
+        tfSdk.reset(new SDK(sdkFactory.createSDK(sdkOptions)));
+        return *tfSdk;
+    };
+    runSteadyState(sdkFactory, sdkOptions, createSdk, 0.f, benchmarkName, benchmarkSubType,
+                   prepare, params, observations);
+}
+
+void runBenchmark(Fixture &fixture, const ConfigurationOptions &options,
+                  const std::string &benchmarkName, const std::string &benchmarkSubType,
+                  const InferenceFactory &prepare, const Parameters &params,
+                  ObservationList &observations) {
+    // The cold start needs fresh processes
+    if (!fixture.isCachingSdks() || params.coldStart.enabled) {
+        runBenchmark(fixture.getSDKFactory(), options, benchmarkName, benchmarkSubType, prepare,
+                     params, observations);
+        return;
+    }
+
+    auto sdkOptions = options;
+    sdkOptions.useGlobalInferenceThreadpool = params.inferenceThreading.useGlobalThreadpool;
+    // Created before the memory baseline, whichever benchmark creates it. Its load is added back.
+    SDK &tfSdk = fixture.getSDK(sdkOptions);
+    auto getSdk = [&tfSdk]() -> SDK & { return tfSdk; };
+    runSteadyState(fixture.getSDKFactory(), sdkOptions, getSdk,
+                   fixture.getSDKLoadMemory(sdkOptions), benchmarkName, benchmarkSubType, prepare,
+                   params, observations);
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
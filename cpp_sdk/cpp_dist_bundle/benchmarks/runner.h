@@ -0,0 +1,42 @@
+#pragma once
+
+#include "observation.h"
+#include "sdkfactory.h"
+
+#include <functional>
+#include <string>
+
+// fwd declarations
+namespace Trueface {
+enum class ErrorCode;
+} // namespace Trueface
+
+namespace Trueface {
+namespace Benchmarks {
+
+class Fixture;
+
+// A single call to the SDK method being benchmarked
+using Inference = std::function<Trueface::ErrorCode()>;
+
+// Prepares the benchmark inputs on the given SDK instance and returns the inference to time.
+// Called once per SDK instance and once per thread, so the inference must own its outputs.
+// Returns false if the inputs could not be prepared.
+using InferenceFactory = std::function<bool(Trueface::SDK &, Inference &)>;
+
+// Times the inference on a single thread, and when params.numThreads > 1 also measures the
+// aggregate throughput of numThreads threads sharing one SDK and using one SDK per thread.
+// When params.openLoop is enabled, then drives the inference open loop, see open_loop.h.
+// When params.coldStart is enabled, measures the model load and first inference instead.
+void runBenchmark(const SDKFactory &sdkFactory, const Trueface::ConfigurationOptions &options,
+                  const std::string &benchmarkName, const std::string &benchmarkSubType,
+                  const InferenceFactory &prepare, const Parameters &params,
+                  ObservationList &observations);
+// Same on the SDK instance of the fixture for the options, when it caches them
+void runBenchmark(Fixture &fixture, const Trueface::ConfigurationOptions &options,
+                  const std::string &benchmarkName, const std::string &benchmarkSubType,
+                  const InferenceFactory &prepare, const Parameters &params,
+                  ObservationList &observations);
+
+} // namespace Benchmarks
+} // namespace Trueface
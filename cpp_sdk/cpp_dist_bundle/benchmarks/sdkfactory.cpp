@@ -1,4 +1,5 @@
 #include "sdkfactory.h"
+#include "stopwatch.h"
 
 #include "tf_data_types.h"
 #include "tf_sdk.h"
@@ -29,6 +30,23 @@ SDK SDKFactory::createSDK(const ConfigurationOptions &options) const {
     return tfSdk;
 }
 
+SDK SDKFactory::createSDK(const ConfigurationOptions &options, float &constructorTime,
+                          float &setLicenseTime) const {
+    preciseStopwatch constructorStopwatch;
+    SDK tfSdk(options);
+    constructorTime = constructorStopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+
+    preciseStopwatch setLicenseStopwatch;
+    bool valid = tfSdk.setLicense(m_license);
+    setLicenseTime = setLicenseStopwatch.elapsedTime<float, std::chrono::nanoseconds>();
+    if (!valid) {
+        std::cout << "Error: the provided license is invalid." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return tfSdk;
+}
+
 ConfigurationOptions SDKFactory::createBasicConfiguration() const {
     ConfigurationOptions options;
     options.modelsPath = m_modelsPath;
@@ -15,6 +15,9 @@ public:
     SDKFactory(const Trueface::GPUOptions &gpuOptions);
 
     Trueface::SDK createSDK(const Trueface::ConfigurationOptions &options) const;
+    // Also returns the time spent in the SDK constructor and in setLicense, in nanoseconds
+    Trueface::SDK createSDK(const Trueface::ConfigurationOptions &options, float &constructorTime,
+                            float &setLicenseTime) const;
     Trueface::ConfigurationOptions createBasicConfiguration() const;
     static Trueface::GPUOptions createGPUOptions(bool enableGPU, unsigned int deviceIndex,
                                                  int32_t maxBatchSize, int32_t optBatchSize);
@@ -0,0 +1,155 @@
+#include "similarity_kernel.h"
+
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMILARITY_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+float toCosine(float dot, float normA, float normB) {
+    const float norms = std::sqrt(normA * normB);
+    return norms > 0.f ? dot / norms : 0.f;
+}
+
+float cosineScalar(const float *a, const float *b, size_t size) {
+    float dot = 0.f;
+    float normA = 0.f;
+    float normB = 0.f;
+    for (size_t i = 0; i < size; ++i) {
+        dot += a[i] * b[i];
+        normA += a[i] * a[i];
+        normB += b[i] * b[i];
+    }
+    return toCosine(dot, normA, normB);
+}
+
+#ifdef SIMILARITY_KERNEL_X86
+
+// The kernels are compiled for their instruction set whatever the flags of the build, and only
+// called once the CPU was found to support it
+
+__attribute__((target("avx2,fma"))) float horizontalSum(__m256 values) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2,fma"))) float cosineAvx2(const float *a, const float *b,
+                                                     size_t size) {
+    __m256 dot = _mm256_setzero_ps();
+    __m256 normA = _mm256_setzero_ps();
+    __m256 normB = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256 x = _mm256_loadu_ps(a + i);
+        const __m256 y = _mm256_loadu_ps(b + i);
+        dot = _mm256_fmadd_ps(x, y, dot);
+        normA = _mm256_fmadd_ps(x, x, normA);
+        normB = _mm256_fmadd_ps(y, y, normB);
+    }
+
+    float dotSum = horizontalSum(dot);
+    float normASum = horizontalSum(normA);
+    float normBSum = horizontalSum(normB);
+    for (; i < size; ++i) {
+        dotSum += a[i] * b[i];
+        normASum += a[i] * a[i];
+        normBSum += b[i] * b[i];
+    }
+    return toCosine(dotSum, normASum, normBSum);
+}
+
+__attribute__((target("avx512f"))) float horizontalSum(__m512 values) {
+    // summed through memory, the extract intrinsics warn about their undefined upper lanes
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, values);
+    float sum = 0.f;
+    for (float lane : lanes) {
+        sum += lane;
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f"))) float cosineAvx512(const float *a, const float *b,
+                                                      size_t size) {
+    __m512 dot = _mm512_setzero_ps();
+    __m512 normA = _mm512_setzero_ps();
+    __m512 normB = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m512 x = _mm512_loadu_ps(a + i);
+        const __m512 y = _mm512_loadu_ps(b + i);
+        dot = _mm512_fmadd_ps(x, y, dot);
+        normA = _mm512_fmadd_ps(x, x, normA);
+        normB = _mm512_fmadd_ps(y, y, normB);
+    }
+
+    // the remainder is masked rather than looped over
+    if (i < size) {
+        const __mmask16 mask = static_cast<__mmask16>((1u << (size - i)) - 1);
+        const __m512 x = _mm512_maskz_loadu_ps(mask, a + i);
+        const __m512 y = _mm512_maskz_loadu_ps(mask, b + i);
+        dot = _mm512_fmadd_ps(x, y, dot);
+        normA = _mm512_fmadd_ps(x, x, normA);
+        normB = _mm512_fmadd_ps(y, y, normB);
+    }
+    return toCosine(horizontalSum(dot), horizontalSum(normA), horizontalSum(normB));
+}
+
+#endif
+
+} // namespace
+
+SimdLevel getSupportedSimdLevel() {
+#ifdef SIMILARITY_KERNEL_X86
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::SCALAR;
+}
+
+const char *toString(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::AVX512:
+        return "AVX-512";
+    default:
+        return "scalar";
+    }
+}
+
+float cosineSimilarity(const float *a, const float *b, size_t size, SimdLevel level) {
+#ifdef SIMILARITY_KERNEL_X86
+    if (level == SimdLevel::AVX512) {
+        return cosineAvx512(a, b, size);
+    }
+    if (level == SimdLevel::AVX2) {
+        return cosineAvx2(a, b, size);
+    }
+#else
+    (void)level;
+#endif
+    return cosineScalar(a, b, size);
+}
+
+void cosineSimilarities(const float *a, const float *b, size_t numPairs, size_t size,
+                        float *similarities, SimdLevel level) {
+    for (size_t i = 0; i < numPairs; ++i) {
+        similarities[i] = cosineSimilarity(a + i * size, b + i * size, size, level);
+    }
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
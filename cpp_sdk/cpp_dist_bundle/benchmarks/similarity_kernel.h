@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Trueface {
+namespace Benchmarks {
+
+enum class SimdLevel { SCALAR, AVX2, AVX512 };
+
+// Widest instruction set supported by both the CPU and the compiler. Only GCC and Clang builds
+// for x86 get the AVX2 and AVX-512 kernels, every other build uses the scalar one.
+SimdLevel getSupportedSimdLevel();
+
+const char *toString(SimdLevel level);
+
+// Cosine similarity of the raw feature vectors of two uncompressed Faceprints, computed with the
+// given instruction set, which must be supported
+float cosineSimilarity(const float *a, const float *b, size_t size, SimdLevel level);
+
+// Cosine similarities of numPairs pairs of feature vectors stored one after the other in a and b,
+// for bulk 1:1 verification without a call into the SDK per pair
+void cosineSimilarities(const float *a, const float *b, size_t numPairs, size_t size,
+                        float *similarities, SimdLevel level);
+
+} // namespace Benchmarks
+} // namespace Trueface
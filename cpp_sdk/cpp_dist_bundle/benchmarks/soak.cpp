@@ -0,0 +1,414 @@
+#include "allocation_counters.h"
+#include "file_io.h"
+#include "memory_high_water_mark.h"
+#include "soak.h"
+#include "statistics.h"
+#include "stopwatch.h"
+
+#include "tf_data_types.h"
+#include "tf_sdk.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <dirent.h>
+#endif
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum Stage {
+    PREPROCESS,
+    DETECT,
+    ALIGN,
+    RECOGNIZE,
+    LANDMARKS,
+    HEAD_ORIENTATION,
+    GLASSES,
+    SPOOF,
+    MASK,
+    BLINK,
+    BLUR,
+    TEMPLATE_QUALITY,
+    OBJECTS,
+    NUM_STAGES
+};
+
+const char *stageNames[NUM_STAGES] = {"preprocessImage",
+                                      "detectLargestFace",
+                                      "extractAlignedFace",
+                                      "getFaceFeatureVectors",
+                                      "getFaceLandmarks",
+                                      "estimateHeadOrientation",
+                                      "detectGlasses",
+                                      "detectSpoof",
+                                      "detectMasks",
+                                      "detectBlinks",
+                                      "detectFaceImageBlurs",
+                                      "estimateFaceTemplateQualities",
+                                      "detectObjects"};
+
+// Frames of the mix, as the encoded JPGs a camera or a client would send
+const std::vector<std::string> framePaths = {
+    "../images/headshot.jpg", "../../images/brad_pitt_1.jpg", "../../images/tom_cruise_2.jpg",
+    "../../images/person_on_bike.jpg"};
+
+// A trend is flagged when the fit explains at least this fraction of the variance and the memory
+// grows faster than maxMemoryGrowth MB per hour, the number of open files grows by at least one
+// over the soak, or a p99 latency grows by more than maxLatencyDrift of its fitted start value
+constexpr double minRSquared{0.5};
+constexpr double maxMemoryGrowth{1.0};
+constexpr double maxLatencyDrift{0.1};
+
+struct WindowSample {
+    // Time from the start of the soak to the end of the window, in hours
+    float elapsed;
+    unsigned int numCycles;
+    float rss;
+    bool hasAllocationCounts;
+    float liveHeap;
+    uint64_t numAllocations;
+    int numOpenFiles;
+    float p50[NUM_STAGES];
+    float p99[NUM_STAGES];
+    unsigned int numCalls[NUM_STAGES];
+};
+
+// Number of file descriptors open in the process, -1 where not supported
+int countOpenFiles() {
+#if !defined(WIN32) && !defined(_WIN32)
+#ifdef __APPLE__
+    DIR *directory = opendir("/dev/fd");
+#else
+    DIR *directory = opendir("/proc/self/fd");
+#endif
+    if (!directory) {
+        return -1;
+    }
+    int numFiles = 0;
+    while (const dirent *entry = readdir(directory)) {
+        if (entry->d_name[0] != '.') {
+            ++numFiles;
+        }
+    }
+    closedir(directory);
+    // the directory being read is open too
+    return numFiles - 1;
+#else
+    return -1;
+#endif
+}
+
+// Runs one frame through the mix, with new images, face chips and outputs every time so that their
+// allocation and release is soaked too. Appends the time of every stage in ms to stageTimes.
+// The face stages are skipped when no face is found.
+ErrorCode runCycle(SDK &tfSdk, const std::vector<uint8_t> &frame,
+                   std::vector<float> stageTimes[NUM_STAGES]) {
+    auto time = [&](Stage stage, preciseStopwatch &stopwatch) {
+        stageTimes[stage].emplace_back(stopwatch.elapsedTime<float, std::chrono::nanoseconds>() /
+                                       1e6f);
+        stopwatch = preciseStopwatch();
+    };
+
+    preciseStopwatch stopwatch;
+    TFImage img;
+    auto errorCode = tfSdk.preprocessImage(frame, img);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(PREPROCESS, stopwatch);
+
+    std::vector<BoundingBox> boundingBoxes;
+    errorCode = tfSdk.detectObjects(img, boundingBoxes);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(OBJECTS, stopwatch);
+
+    FaceBoxAndLandmarks faceBoxAndLandmarks;
+    bool found = false;
+    errorCode = tfSdk.detectLargestFace(img, faceBoxAndLandmarks, found);
+    if (errorCode != ErrorCode::NO_ERROR || !found) {
+        return errorCode;
+    }
+    time(DETECT, stopwatch);
+
+    TFFacechip facechip;
+    errorCode = tfSdk.extractAlignedFace(img, faceBoxAndLandmarks, facechip);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(ALIGN, stopwatch);
+
+    const std::vector<TFFacechip> facechips{facechip};
+    std::vector<Faceprint> faceprints;
+    errorCode = tfSdk.getFaceFeatureVectors(facechips, faceprints);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(RECOGNIZE, stopwatch);
+
+    Landmarks landmarks;
+    errorCode = tfSdk.getFaceLandmarks(img, faceBoxAndLandmarks, landmarks);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(LANDMARKS, stopwatch);
+
+    HeadOrientation headOrientation;
+    errorCode = tfSdk.estimateHeadOrientation(img, faceBoxAndLandmarks, landmarks, headOrientation);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(HEAD_ORIENTATION, stopwatch);
+
+    GlassesLabel glassesLabel{};
+    float glassesScore{};
+    errorCode = tfSdk.detectGlasses(img, faceBoxAndLandmarks, glassesLabel, glassesScore);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(GLASSES, stopwatch);
+
+    SpoofLabel spoofLabel{};
+    float spoofScore{};
+    errorCode = tfSdk.detectSpoof(img, faceBoxAndLandmarks, spoofLabel, spoofScore);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(SPOOF, stopwatch);
+
+    std::vector<MaskLabel> maskLabels;
+    std::vector<float> maskScores;
+    errorCode = tfSdk.detectMasks(facechips, maskLabels, maskScores);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(MASK, stopwatch);
+
+    const std::vector<TFImage> images{img};
+    const std::vector<Landmarks> landmarksVec{landmarks};
+    std::vector<BlinkState> blinkStates;
+    errorCode = tfSdk.detectBlinks(images, landmarksVec, blinkStates);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(BLINK, stopwatch);
+
+    std::vector<FaceImageQuality> qualities;
+    std::vector<float> blurScores;
+    errorCode = tfSdk.detectFaceImageBlurs(facechips, qualities, blurScores);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(BLUR, stopwatch);
+
+    std::vector<bool> areQualitiesGood;
+    std::vector<float> qualityScores;
+    errorCode = tfSdk.estimateFaceTemplateQualities(facechips, areQualitiesGood, qualityScores);
+    if (errorCode != ErrorCode::NO_ERROR) {
+        return errorCode;
+    }
+    time(TEMPLATE_QUALITY, stopwatch);
+    return ErrorCode::NO_ERROR;
+}
+
+void writeHeader(std::ofstream &csv) {
+    csv << "Window,Elapsed (h),Stage,Calls,p50 (ms),p99 (ms),RSS (MB),Live Heap (MB),"
+           "Allocations,Open Files"
+        << std::endl;
+}
+
+void writeWindow(std::ofstream &csv, size_t index, const WindowSample &window) {
+    for (size_t stage = 0; stage < NUM_STAGES; ++stage) {
+        csv << index << "," << window.elapsed << "," << stageNames[stage] << ","
+            << window.numCalls[stage] << "," << window.p50[stage] << "," << window.p99[stage]
+            << "," << window.rss << ",";
+        if (window.hasAllocationCounts) {
+            csv << window.liveHeap << "," << window.numAllocations;
+        } else {
+            csv << ",";
+        }
+        csv << "," << window.numOpenFiles << std::endl;
+    }
+}
+
+// Fits the trends of the windows after the first, prints them, and returns false when one of them
+// is flagged
+bool checkTrends(const std::vector<WindowSample> &windows) {
+    if (windows.size() < 4) {
+        std::cout << "Too few windows to fit trends, soak for longer or shorten the windows"
+                  << std::endl;
+        return true;
+    }
+
+    std::vector<float> elapsed;
+    for (size_t i = 1; i < windows.size(); ++i) {
+        elapsed.push_back(windows[i].elapsed);
+    }
+    const float span = elapsed.back() - elapsed.front();
+    auto series = [&](const std::function<float(const WindowSample &)> &value) {
+        std::vector<float> values;
+        for (size_t i = 1; i < windows.size(); ++i) {
+            values.push_back(value(windows[i]));
+        }
+        return values;
+    };
+
+    bool isOk = true;
+    const auto rssFit = linearFit(elapsed, series([](const WindowSample &w) { return w.rss; }));
+    std::cout << "RSS trend: " << rssFit.slope << " MB/hour (R^2 " << rssFit.rSquared << ")";
+    if (rssFit.slope > maxMemoryGrowth && rssFit.rSquared >= minRSquared) {
+        std::cout << " <- memory growth, possible leak";
+        isOk = false;
+    }
+    std::cout << std::endl;
+
+    if (windows.back().hasAllocationCounts) {
+        const auto heapFit =
+            linearFit(elapsed, series([](const WindowSample &w) { return w.liveHeap; }));
+        std::cout << "Live heap trend: " << heapFit.slope << " MB/hour (R^2 " << heapFit.rSquared
+                  << ")";
+        if (heapFit.slope > maxMemoryGrowth && heapFit.rSquared >= minRSquared) {
+            std::cout << " <- heap growth, possible leak";
+            isOk = false;
+        }
+        std::cout << std::endl;
+    }
+
+    if (windows.back().numOpenFiles >= 0) {
+        const auto filesFit = linearFit(elapsed, series([](const WindowSample &w) {
+                                            return static_cast<float>(w.numOpenFiles);
+                                        }));
+        std::cout << "Open files trend: " << filesFit.slope << " per hour (R^2 "
+                  << filesFit.rSquared << ")";
+        if (filesFit.slope * span >= 1.0 && filesFit.rSquared >= minRSquared) {
+            std::cout << " <- file descriptor leak";
+            isOk = false;
+        }
+        std::cout << std::endl;
+    }
+
+    for (size_t stage = 0; stage < NUM_STAGES; ++stage) {
+        // the windows in which the stage never ran, as no face was found, have no latency
+        std::vector<float> stageElapsed;
+        std::vector<float> p99;
+        for (size_t i = 1; i < windows.size(); ++i) {
+            if (windows[i].numCalls[stage] > 0) {
+                stageElapsed.push_back(windows[i].elapsed);
+                p99.push_back(windows[i].p99[stage]);
+            }
+        }
+        if (stageElapsed.size() < 3) {
+            continue;
+        }
+        const auto p99Fit = linearFit(stageElapsed, p99);
+        const double start = p99Fit.slope * stageElapsed.front() + p99Fit.intercept;
+        const double drift =
+            start > 0.0 ? p99Fit.slope * (stageElapsed.back() - stageElapsed.front()) / start
+                        : 0.0;
+        std::cout << stageNames[stage] << " p99 trend: " << p99Fit.slope << " ms/hour, "
+                  << drift * 100.0 << "% over the soak (R^2 " << p99Fit.rSquared << ")";
+        if (drift > maxLatencyDrift && p99Fit.rSquared >= minRSquared) {
+            std::cout << " <- latency drift";
+            isOk = false;
+        }
+        std::cout << std::endl;
+    }
+    return isOk;
+}
+
+} // namespace
+
+bool runSoak(const SDKFactory &sdkFactory, const SoakOptions &options,
+             const InferenceThreading &inferenceThreading) {
+    auto sdkOptions = sdkFactory.createBasicConfiguration();
+    sdkOptions.frModel = FacialRecognitionModel::TFV7;
+    sdkOptions.useGlobalInferenceThreadpool = inferenceThreading.useGlobalThreadpool;
+    auto tfSdk = sdkFactory.createSDK(sdkOptions);
+
+    std::vector<std::vector<uint8_t>> frames(framePaths.size());
+    for (size_t i = 0; i < framePaths.size(); ++i) {
+        if (!readFile(framePaths[i], frames[i])) {
+            std::cout << "Error: could not load the image " << framePaths[i] << std::endl;
+            return false;
+        }
+    }
+
+    std::ofstream csv{options.csvPath};
+    if (!csv) {
+        std::cout << "Error: could not open " << options.csvPath << std::endl;
+        return false;
+    }
+    writeHeader(csv);
+
+    std::cout << "Soaking for " << options.duration << " hours with " << options.windowDuration
+              << " s windows" << std::endl;
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration_cast<Clock::duration>(
+                                 std::chrono::duration<double>(options.duration * 3600.0));
+    const auto windowDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.windowDuration));
+
+    std::vector<WindowSample> windows;
+    AllocationCounters previousCounters{};
+    readAllocationCounters(previousCounters);
+    size_t nextFrame = 0;
+    while (Clock::now() < end) {
+        const auto windowEnd = std::min(end, Clock::now() + windowDuration);
+        std::vector<float> stageTimes[NUM_STAGES];
+        WindowSample window{};
+        while (Clock::now() < windowEnd) {
+            auto errorCode = runCycle(tfSdk, frames[nextFrame++ % frames.size()], stageTimes);
+            if (errorCode != ErrorCode::NO_ERROR) {
+                std::cout << "Error: the soak failed" << std::endl;
+                std::cout << errorCode << std::endl;
+                return false;
+            }
+            ++window.numCycles;
+        }
+
+        window.elapsed = std::chrono::duration<float>(Clock::now() - start).count() / 3600.f;
+        window.rss = getResidentSetSize();
+        window.numOpenFiles = countOpenFiles();
+        AllocationCounters counters{};
+        if (readAllocationCounters(counters)) {
+            window.hasAllocationCounts = true;
+            window.liveHeap = counters.liveBytes / 1e6f;
+            window.numAllocations = counters.numAllocations - previousCounters.numAllocations;
+            previousCounters = counters;
+        }
+        for (size_t stage = 0; stage < NUM_STAGES; ++stage) {
+            window.numCalls[stage] = static_cast<unsigned int>(stageTimes[stage].size());
+            window.p50[stage] = quantile(stageTimes[stage], 0.5);
+            window.p99[stage] = quantile(stageTimes[stage], 0.99);
+        }
+
+        writeWindow(csv, windows.size(), window);
+        std::cout << "Window " << windows.size() << ", " << window.elapsed << " h: "
+                  << window.numCycles << " cycles, RSS " << window.rss << " MB";
+        if (window.hasAllocationCounts) {
+            std::cout << ", live heap " << window.liveHeap << " MB";
+        }
+        if (window.numOpenFiles >= 0) {
+            std::cout << ", " << window.numOpenFiles << " open files";
+        }
+        std::cout << std::endl;
+        windows.push_back(window);
+    }
+
+    return checkTrends(windows);
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "observation.h"
+#include "sdkfactory.h"
+
+#include <string>
+
+namespace Trueface {
+namespace Benchmarks {
+
+struct SoakOptions {
+    bool enabled;
+    // Duration of the soak, in hours
+    float duration;
+    // Duration of the windows the latency percentiles and the memory are sampled over, in seconds
+    float windowDuration;
+    // One row per window and stage is written to this file
+    std::string csvPath;
+};
+
+// Cycles the module mix of a service on one SDK for hours: every cycle decodes a frame into a new
+// TFImage, detects the faces, extracts a new TFFacechip and runs recognition and the face
+// attribute modules on it. The latency percentiles of every stage, the resident set size, the
+// allocator counters and the number of open files are sampled per window, and a linear trend is
+// fitted to them once the first window has warmed up the caches.
+// Returns false on error, or when a trend flags memory or open file growth or latency drift.
+bool runSoak(const SDKFactory &sdkFactory, const SoakOptions &options,
+             const InferenceThreading &inferenceThreading);
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,242 @@
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+// Two sided critical value of the standard normal distribution, found by bisection
+double normalCriticalValue(double confidence) {
+    const double tail = 1.0 - confidence;
+    double low = 0.0;
+    double high = 10.0;
+    for (int i = 0; i < 60; ++i) {
+        const double z = (low + high) / 2.0;
+        if (std::erfc(z / std::sqrt(2.0)) > tail) {
+            low = z;
+        } else {
+            high = z;
+        }
+    }
+    return (low + high) / 2.0;
+}
+
+// The quantile confidence interval of values sorted in ascending order
+ConfidenceInterval sortedQuantileConfidenceInterval(const std::vector<float> &values,
+                                                    double quantile, double confidence) {
+    if (values.empty()) {
+        return ConfidenceInterval{0.0, 0.0, 0.0};
+    }
+
+    const double n = values.size();
+    const auto rank = [&](double r) {
+        return static_cast<size_t>(std::min(std::max(r, 0.0), n - 1.0));
+    };
+
+    // the rank of the quantile is binomial(n, quantile), approximated by a normal distribution
+    const double spread =
+        normalCriticalValue(confidence) * std::sqrt(n * quantile * (1.0 - quantile));
+    const double center = n * quantile;
+    const double high = std::ceil(center + spread);
+    return ConfidenceInterval{values[rank(center)], values[rank(std::floor(center - spread))],
+                              high <= n - 1.0 ? values[rank(high)]
+                                              : std::numeric_limits<double>::infinity()};
+}
+} // namespace
+
+float median(std::vector<float> values) {
+    if (values.empty()) {
+        return 0.f;
+    }
+
+    const auto mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    if (values.size() % 2) {
+        return values[mid];
+    }
+
+    const auto lower = *std::max_element(values.begin(), values.begin() + mid);
+    return (lower + values[mid]) / 2.f;
+}
+
+float quantile(std::vector<float> values, double quantile) {
+    if (values.empty()) {
+        return 0.f;
+    }
+
+    const auto rank = std::min(values.size() - 1, static_cast<size_t>(quantile * values.size()));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+ConfidenceInterval meanConfidenceInterval(const std::vector<float> &values, double confidence) {
+    if (values.empty()) {
+        return ConfidenceInterval{0.0, 0.0, 0.0};
+    }
+
+    double sum = 0.0;
+    for (auto value : values) {
+        sum += value;
+    }
+    const double mean = sum / values.size();
+    if (values.size() < 2) {
+        return ConfidenceInterval{mean, mean, mean};
+    }
+
+    double sumOfSquares = 0.0;
+    for (auto value : values) {
+        sumOfSquares += (value - mean) * (value - mean);
+    }
+    const double standardError = std::sqrt(sumOfSquares / (values.size() - 1) / values.size());
+    const double halfWidth = normalCriticalValue(confidence) * standardError;
+    return ConfidenceInterval{mean, mean - halfWidth, mean + halfWidth};
+}
+
+ConfidenceInterval quantileConfidenceInterval(std::vector<float> values, double quantile,
+                                              double confidence) {
+    std::sort(values.begin(), values.end());
+    return sortedQuantileConfidenceInterval(values, quantile, confidence);
+}
+
+ConfidenceInterval quantileConfidenceInterval(const std::vector<float> &values, double quantile,
+                                              double confidence, std::vector<float> &sorted) {
+    sorted.assign(values.begin(), values.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sortedQuantileConfidenceInterval(sorted, quantile, confidence);
+}
+
+MannWhitneyResult mannWhitneyU(const std::vector<float> &a, const std::vector<float> &b) {
+    const double n1 = a.size();
+    const double n2 = b.size();
+    if (a.empty() || b.empty()) {
+        return MannWhitneyResult{0.5, 1.0};
+    }
+
+    // rank the pooled samples, ties get the average of their ranks
+    std::vector<std::pair<float, bool>> pooled;
+    pooled.reserve(a.size() + b.size());
+    for (auto value : a) {
+        pooled.emplace_back(value, true);
+    }
+    for (auto value : b) {
+        pooled.emplace_back(value, false);
+    }
+    std::sort(pooled.begin(), pooled.end());
+
+    double rankSumA = 0.0;
+    double tieCorrection = 0.0;
+    for (size_t i = 0; i < pooled.size();) {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+            ++j;
+        }
+
+        const double averageRank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; ++k) {
+            if (pooled[k].second) {
+                rankSumA += averageRank;
+            }
+        }
+
+        const double numTied = j - i;
+        tieCorrection += numTied * numTied * numTied - numTied;
+        i = j;
+    }
+
+    const double n = n1 + n2;
+    const double u = rankSumA - n1 * (n1 + 1) / 2.0;
+    const double meanU = n1 * n2 / 2.0;
+    const double varianceU = n1 * n2 / 12.0 * ((n + 1) - tieCorrection / (n * (n - 1)));
+    if (varianceU <= 0.0) {
+        return MannWhitneyResult{0.5, 1.0};
+    }
+
+    // continuity correction towards the mean
+    const double delta = std::abs(u - meanU);
+    const double z = std::max(0.0, delta - 0.5) / std::sqrt(varianceU);
+    const double pValue = std::erfc(z / std::sqrt(2.0));
+
+    return MannWhitneyResult{u / (n1 * n2), pValue};
+}
+
+LinearFit linearFit(const std::vector<float> &x, const std::vector<float> &y) {
+    LinearFit fit{0.0, 0.0, 0.0};
+    const size_t n = std::min(x.size(), y.size());
+    if (n == 0) {
+        return fit;
+    }
+
+    double meanX = 0.0;
+    double meanY = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        meanX += x[i];
+        meanY += y[i];
+    }
+    meanX /= n;
+    meanY /= n;
+
+    double covariance = 0.0;
+    double varianceX = 0.0;
+    double varianceY = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        covariance += (x[i] - meanX) * (y[i] - meanY);
+        varianceX += (x[i] - meanX) * (x[i] - meanX);
+        varianceY += (y[i] - meanY) * (y[i] - meanY);
+    }
+
+    fit.slope = varianceX > 0.0 ? covariance / varianceX : 0.0;
+    fit.intercept = meanY - fit.slope * meanX;
+    if (varianceX > 0.0 && varianceY > 0.0) {
+        fit.rSquared = covariance * covariance / (varianceX * varianceY);
+    }
+    return fit;
+}
+
+ConfidenceInterval bootstrapMedianRatio(const std::vector<float> &a, const std::vector<float> &b,
+                                        double confidence, unsigned int numResamples) {
+    const auto medianB = median(b);
+    const double estimate = medianB > 0.f ? median(a) / medianB : 0.0;
+    if (a.empty() || b.empty() || numResamples == 0) {
+        return ConfidenceInterval{estimate, estimate, estimate};
+    }
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<size_t> pickA{0, a.size() - 1};
+    std::uniform_int_distribution<size_t> pickB{0, b.size() - 1};
+
+    std::vector<double> ratios;
+    ratios.reserve(numResamples);
+    std::vector<float> resampleA(a.size());
+    std::vector<float> resampleB(b.size());
+    for (unsigned int i = 0; i < numResamples; ++i) {
+        for (auto &value : resampleA) {
+            value = a[pickA(generator)];
+        }
+        for (auto &value : resampleB) {
+            value = b[pickB(generator)];
+        }
+
+        const auto resampledMedianB = median(resampleB);
+        if (resampledMedianB > 0.f) {
+            ratios.push_back(median(resampleA) / resampledMedianB);
+        }
+    }
+
+    if (ratios.empty()) {
+        return ConfidenceInterval{estimate, estimate, estimate};
+    }
+
+    std::sort(ratios.begin(), ratios.end());
+    const double tail = (1.0 - confidence) / 2.0;
+    const auto lowIndex = static_cast<size_t>(tail * (ratios.size() - 1));
+    const auto highIndex = static_cast<size_t>((1.0 - tail) * (ratios.size() - 1));
+    return ConfidenceInterval{estimate, ratios[lowIndex], ratios[highIndex]};
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
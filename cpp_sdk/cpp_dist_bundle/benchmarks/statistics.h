@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+float median(std::vector<float> values);
+
+// Nearest rank quantile (between 0 and 1), 0 when there are no values
+float quantile(std::vector<float> values, double quantile);
+
+struct MannWhitneyResult {
+    // Probability that a sample of a is larger than a sample of b, 0.5 when indistinguishable
+    double commonLanguageEffectSize;
+    // Two sided p-value, from the normal approximation with tie correction
+    double pValue;
+};
+
+// Non-parametric test of whether the two samples come from the same distribution
+MannWhitneyResult mannWhitneyU(const std::vector<float> &a, const std::vector<float> &b);
+
+struct ConfidenceInterval {
+    double estimate;
+    double low;
+    double high;
+};
+
+// Normal approximation confidence interval of the mean
+ConfidenceInterval meanConfidenceInterval(const std::vector<float> &values, double confidence);
+
+// Distribution free confidence interval of the quantile (between 0 and 1), bounded by the order
+// statistics whose ranks straddle it. The upper bound is infinite when there are too few samples.
+ConfidenceInterval quantileConfidenceInterval(std::vector<float> values, double quantile,
+                                              double confidence);
+
+// Same, sorting a copy of the values in sorted, whose capacity is reused from one call to the next
+ConfidenceInterval quantileConfidenceInterval(const std::vector<float> &values, double quantile,
+                                              double confidence, std::vector<float> &sorted);
+
+struct LinearFit {
+    double slope;
+    double intercept;
+    // Fraction of the variance of y explained by the fit, 0 when y is constant
+    double rSquared;
+};
+
+// Ordinary least squares fit of y = slope * x + intercept
+LinearFit linearFit(const std::vector<float> &x, const std::vector<float> &y);
+
+// Percentile bootstrap confidence interval of median(a) / median(b).
+// The seed is fixed so that reports are reproducible.
+ConfidenceInterval bootstrapMedianRatio(const std::vector<float> &a, const std::vector<float> &b,
+                                        double confidence, unsigned int numResamples = 1000);
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -19,6 +19,8 @@ public:
         std::atomic_thread_fence(std::memory_order_relaxed);
         return static_cast<Rep>(counted_time);
     }
+
+    typename Clock::time_point getStartPoint() const { return start_point; }
 };
 
 using preciseStopwatch = Stopwatch<>;
@@ -0,0 +1,87 @@
+#include "template_generator.h"
+
+#include <cmath>
+#include <random>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+// Independent random streams for the cluster centers, identities and templates
+enum Stream : uint64_t { CLUSTER = 1, IDENTITY = 2, TEMPLATE = 3 };
+
+// splitmix64, to derive well mixed seeds from consecutive indices
+uint64_t mix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+void normalize(std::vector<float> &values) {
+    double norm = 0.0;
+    for (auto value : values) {
+        norm += static_cast<double>(value) * value;
+    }
+    norm = std::sqrt(norm);
+    if (norm > 0.0) {
+        for (auto &value : values) {
+            value = static_cast<float>(value / norm);
+        }
+    }
+}
+} // namespace
+
+TemplateGenerator::TemplateGenerator(const Faceprint &prototype,
+                                     const TemplateGeneratorOptions &options)
+    : m_prototype{prototype}, m_options{options}, m_dimension{prototype.featureVector.size()} {
+    m_prototype.featureVector.clear();
+}
+
+void TemplateGenerator::generateGaussian(uint64_t stream, uint64_t index, float stddev,
+                                         std::vector<float> &values) const {
+    std::mt19937_64 engine{mix(mix(m_options.seed ^ (stream << 56)) ^ index)};
+    std::normal_distribution<float> distribution{0.f, stddev};
+    values.resize(m_dimension);
+    for (auto &value : values) {
+        value = distribution(engine);
+    }
+}
+
+void TemplateGenerator::generateIdentity(uint64_t identity, std::vector<float> &center) const {
+    // the per component standard deviation of spread / sqrt(d) gives an offset of norm spread
+    const float componentSpread = 1.f / std::sqrt(static_cast<float>(m_dimension));
+    if (m_options.numClusters == 0) {
+        generateGaussian(IDENTITY, identity, componentSpread, center);
+        normalize(center);
+        return;
+    }
+
+    generateGaussian(CLUSTER, identity % m_options.numClusters, componentSpread, center);
+    normalize(center);
+    std::vector<float> offset;
+    generateGaussian(IDENTITY, identity, m_options.clusterSpread * componentSpread, offset);
+    for (size_t i = 0; i < m_dimension; ++i) {
+        center[i] += offset[i];
+    }
+    normalize(center);
+}
+
+void TemplateGenerator::generateTemplate(const std::vector<float> &center, uint64_t identity,
+                                         uint64_t sample, Faceprint &faceprint) const {
+    const float componentSpread =
+        m_options.identitySpread / std::sqrt(static_cast<float>(m_dimension));
+    faceprint = m_prototype;
+    generateGaussian(TEMPLATE, mix(identity) ^ sample, componentSpread, faceprint.featureVector);
+    for (size_t i = 0; i < m_dimension; ++i) {
+        faceprint.featureVector[i] += center[i];
+    }
+    normalize(faceprint.featureVector);
+}
+
+std::string TemplateGenerator::getIdentityName(uint64_t identity) {
+    return "identity " + std::to_string(identity);
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
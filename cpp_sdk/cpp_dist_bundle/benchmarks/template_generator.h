@@ -0,0 +1,52 @@
+#pragma once
+
+#include "tf_data_types.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+struct TemplateGeneratorOptions {
+    // Identities are drawn around numClusters cluster centers, standing in for the demographic
+    // groups whose faces are more similar to each other. 0 draws every identity independently.
+    unsigned int numClusters;
+    // Norm of the offset of an identity from its cluster center. Two identities of the same
+    // cluster have a cosine similarity of about 1 / (1 + clusterSpread^2).
+    float clusterSpread;
+    // Norm of the offset of a template from its identity. Two templates of the same identity
+    // have a cosine similarity of about 1 / (1 + identitySpread^2).
+    float identitySpread;
+    uint32_t seed;
+};
+
+// Generates distinct, L2 normalized feature vectors with the same size and metadata as a real
+// template. Every identity and template is derived from the seed and its index, so millions of
+// them can be generated without being stored, and the probes of an identity can be generated
+// long after its templates were enrolled.
+class TemplateGenerator {
+public:
+    TemplateGenerator(const Trueface::Faceprint &prototype,
+                      const TemplateGeneratorOptions &options);
+
+    // The center of the identity, which the templates of the identity are drawn around
+    void generateIdentity(uint64_t identity, std::vector<float> &center) const;
+    // The sample-th template of the identity with the given center
+    void generateTemplate(const std::vector<float> &center, uint64_t identity, uint64_t sample,
+                          Trueface::Faceprint &faceprint) const;
+
+    static std::string getIdentityName(uint64_t identity);
+
+private:
+    void generateGaussian(uint64_t stream, uint64_t index, float stddev,
+                          std::vector<float> &values) const;
+
+    Trueface::Faceprint m_prototype;
+    TemplateGeneratorOptions m_options;
+    size_t m_dimension;
+};
+
+} // namespace Benchmarks
+} // namespace Trueface
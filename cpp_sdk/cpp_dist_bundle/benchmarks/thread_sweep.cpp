@@ -0,0 +1,68 @@
+#include "thread_sweep.h"
+#include "child_process.h"
+#include "cpu_environment.h"
+#include "observation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+// Powers of two up to the number of cores the process may use, and that number itself
+std::vector<unsigned int> getThreadCounts() {
+    const unsigned int numCores = getUsableCpuCount();
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int numThreads = 1; numThreads < numCores; numThreads *= 2) {
+        threadCounts.push_back(numThreads);
+    }
+    threadCounts.push_back(numCores);
+    return threadCounts;
+}
+
+} // namespace
+
+int runInferenceThreadSweep(const std::string &program, const std::vector<std::string> &args,
+                            const std::string &sweepPath) {
+#if !defined(WIN32) && !defined(_WIN32)
+    // start a new sweep file, the children append to it
+    SweepCSVWriter::truncate(sweepPath);
+
+    for (auto useGlobalThreadpool : {true, false}) {
+        for (auto numThreads : getThreadCounts()) {
+            std::cout << "==========================" << std::endl;
+            std::cout << numThreads << " inference threads, global inference threadpool "
+                      << (useGlobalThreadpool ? "on" : "off") << std::endl;
+
+            auto childArgs = args;
+            childArgs.push_back("--global-threadpool");
+            childArgs.push_back(useGlobalThreadpool ? "on" : "off");
+            childArgs.push_back("--sweep-csv");
+            childArgs.push_back(sweepPath);
+            if (!runSelfInChild(program, childArgs,
+                                {{"OMP_NUM_THREADS", std::to_string(numThreads)}})) {
+                std::cout << "Error: the benchmarks failed with " << numThreads
+                          << " inference threads" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    std::cout << "The latency and throughput curves were written to " << sweepPath << std::endl;
+    return EXIT_SUCCESS;
+#else
+    (void)program;
+    (void)args;
+    (void)sweepPath;
+    std::cout << "The inference thread sweep is not supported on Windows, set OMP_NUM_THREADS "
+                 "and run the benchmarks for every thread count instead"
+              << std::endl;
+    return EXIT_FAILURE;
+#endif
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
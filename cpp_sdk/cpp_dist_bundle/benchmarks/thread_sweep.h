@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Runs run_benchmarks again for every inference thread count from 1 to the number of cores, with
+// the global inference threadpool enabled and disabled. The thread count is set through
+// OMP_NUM_THREADS, which is only read when the process starts, so every configuration runs in a
+// new process. The children get the given arguments, and append their results to sweepPath.
+// Returns the exit code of the sweep.
+int runInferenceThreadSweep(const std::string &program, const std::vector<std::string> &args,
+                            const std::string &sweepPath);
+
+} // namespace Benchmarks
+} // namespace Trueface
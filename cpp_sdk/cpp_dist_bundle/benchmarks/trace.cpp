@@ -0,0 +1,122 @@
+#include "trace.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace Trueface {
+namespace Benchmarks {
+
+namespace {
+
+struct TraceRecord {
+    std::string name;
+    const char *phase;
+    unsigned int threadId;
+    // start relative to the epoch of the trace and duration, in microseconds
+    std::vector<std::pair<double, double>> iterations;
+};
+
+std::atomic<bool> isTraceEnabled{false};
+IterationTrace::TimePoint traceEpoch;
+std::mutex traceMutex;
+std::vector<TraceRecord> traceRecords;
+
+// Small sequential ids read better on the timeline than the ids of the OS
+unsigned int getThreadId() {
+    static std::atomic<unsigned int> nextThreadId{1};
+    thread_local unsigned int threadId = nextThreadId++;
+    return threadId;
+}
+
+std::string escapeJson(const std::string &text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+IterationTrace::IterationTrace(const std::string &benchmarkName,
+                               const std::string &benchmarkSubType, const char *phase,
+                               size_t expectedIterations)
+    : m_isEnabled{isTraceEnabled}, m_phase{phase}, m_threadId{0} {
+    if (!m_isEnabled) {
+        return;
+    }
+    m_name = benchmarkSubType.empty() ? benchmarkName
+                                      : benchmarkName + " (" + benchmarkSubType + ")";
+    m_threadId = getThreadId();
+    m_spans.reserve(expectedIterations);
+}
+
+IterationTrace::~IterationTrace() {
+    if (!m_isEnabled || m_spans.empty()) {
+        return;
+    }
+
+    TraceRecord record{m_name, m_phase, m_threadId, {}};
+    record.iterations.reserve(m_spans.size());
+    for (const auto &span : m_spans) {
+        const double start =
+            std::chrono::duration<double, std::micro>(span.start - traceEpoch).count();
+        record.iterations.emplace_back(start, span.duration / 1000.0);
+    }
+
+    std::lock_guard<std::mutex> lock(traceMutex);
+    traceRecords.push_back(std::move(record));
+}
+
+void enableTrace() {
+    traceEpoch = std::chrono::high_resolution_clock::now();
+    isTraceEnabled = true;
+}
+
+bool writeTrace(const std::string &path) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cout << "Error: unable to write the trace to " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(traceMutex);
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool isFirst = true;
+    std::set<unsigned int> threadIds;
+    for (const auto &record : traceRecords) {
+        threadIds.insert(record.threadId);
+        const std::string name = escapeJson(record.name);
+        for (size_t i = 0; i < record.iterations.size(); ++i) {
+            file << (isFirst ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"cat\":\""
+                 << record.phase << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << record.threadId
+                 << ",\"ts\":" << record.iterations[i].first
+                 << ",\"dur\":" << record.iterations[i].second << ",\"args\":{\"iteration\":" << i
+                 << "}}";
+            isFirst = false;
+        }
+    }
+    for (auto threadId : threadIds) {
+        file << (isFirst ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+             << "\"tid\":" << threadId << ",\"args\":{\"name\":\""
+             << (threadId == 1 ? std::string("main") : "thread " + std::to_string(threadId))
+             << "\"}}";
+        isFirst = false;
+    }
+    file << "\n]}\n";
+
+    std::cout << "Wrote the trace of the iterations to " << path << std::endl;
+    return static_cast<bool>(file);
+}
+
+} // namespace Benchmarks
+} // namespace Trueface
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Trueface {
+namespace Benchmarks {
+
+// Records the iterations of one warmup or timing loop as Chrome trace events, which are written
+// with writeTrace once the benchmarks are done. Create it on the thread running the loop, it is
+// recorded as running on that thread. Nothing is recorded unless enableTrace was called.
+class IterationTrace {
+public:
+    using TimePoint = std::chrono::high_resolution_clock::time_point;
+
+    // phase is the category of the events, such as "warmup". The spans are reserved up front so
+    // that the allocation counters do not see an allocation per iteration.
+    IterationTrace(const std::string &benchmarkName, const std::string &benchmarkSubType,
+                   const char *phase, size_t expectedIterations);
+    // Hands the iterations over to the trace
+    ~IterationTrace();
+
+    IterationTrace(const IterationTrace &) = delete;
+    IterationTrace &operator=(const IterationTrace &) = delete;
+
+    // Start of an iteration as read by preciseStopwatch, and its duration in nanoseconds
+    void add(TimePoint start, float duration) {
+        if (m_isEnabled) {
+            m_spans.push_back(Span{start, duration});
+        }
+    }
+
+private:
+    struct Span {
+        TimePoint start;
+        float duration;
+    };
+
+    bool m_isEnabled;
+    std::string m_name;
+    const char *m_phase;
+    unsigned int m_threadId;
+    std::vector<Span> m_spans;
+};
+
+// Starts recording, the timestamps of the trace are relative to this call
+void enableTrace();
+
+// Writes every recorded iteration as a complete event in the Chrome trace event format, with the
+// benchmark name and subtype as event name and one track per thread. The file can be opened in
+// Perfetto (ui.perfetto.dev) or chrome://tracing. Returns false if the file cannot be written.
+bool writeTrace(const std::string &path);
+
+} // namespace Benchmarks
+} // namespace Trueface